@@ -2,21 +2,26 @@
 #define AVLTree_h
 
 #include "TreeNode.h"
+#include "NodePool.h"
 
-template<class T, class S>
+// A tree without a pool is intrusive: its nodes are hooks embedded in the records themselves. They are
+// linked in with link and taken out with unlink, and the tree never creates or destroys a node.
+// A is an aggregate policy (see Aggregate.h). Every node keeps the aggregate of its subtree through
+// insertions, removals, rotations, joins, splits and merges.
+template<class T, class S, class A = NoAggregate>
 class AVLTree {
         //calculate max
         static int max(int a, int b) {
             return (a>b) ? a : b;
         }
 
-        //calculate height of a node
-        static int height(const TreeNode<T, S>* node) {
+        //calculate height of a node from the heights of its sons
+        static int height(const TreeNode<T, S, A>* node) {
             if(node == nullptr) {
                 return 0;
             }
             if (node->left == nullptr){
-                if(node->right == nullptr) 
+                if(node->right == nullptr)
                     return 1;
                 return node->right->height + 1;
             }
@@ -26,20 +31,79 @@ class AVLTree {
             return AVLTree::max(node->left->height, node->right->height) + 1;
         }
 
+        //number of nodes in the subtree of node
+        static int subtreeSize(const TreeNode<T, S, A>* node) {
+            return (node == nullptr) ? 0 : node->size;
+        }
+
+        //the aggregate of the subtree of node
+        static typename A::Value subtreeAggregate(const TreeNode<T, S, A>* node) {
+            return (node == nullptr) ? A::identity() : node->aggregate;
+        }
+
+        //recalculate the aggregate of a node from its sons. nothing to do without an aggregate
+        static void updateAggregate(TreeNode<T, S, A>* node, NoAggregate*) {}
+
+        template<class P>
+        static void updateAggregate(TreeNode<T, S, A>* node, P*) {
+            node->aggregate = A::combine(A::combine(AVLTree::subtreeAggregate(node->left), A::of(node->data, node->key)),
+                AVLTree::subtreeAggregate(node->right));
+        }
+
+        //recalculate the height, the subtree size and the aggregate of a node from its sons
+        static void update(TreeNode<T, S, A>* node) {
+            node->height = AVLTree::height(node);
+            node->size = AVLTree::subtreeSize(node->left) + AVLTree::subtreeSize(node->right) + 1;
+            AVLTree::updateAggregate(node, static_cast<A*>(nullptr));
+        }
+
+        //recalculate the subtree sizes and aggregates from node up to the root
+        static void updateUp(TreeNode<T, S, A>* node) {
+            while(node != nullptr) {
+                node->size = AVLTree::subtreeSize(node->left) + AVLTree::subtreeSize(node->right) + 1;
+                AVLTree::updateAggregate(node, static_cast<A*>(nullptr));
+                node = node->parent;
+            }
+        }
+
+        //recalculate the aggregates of a whole subtree, sons before their parents, without recursion. O(n)
+        static void updateSubtreeAggregates(TreeNode<T, S, A>* root, NoAggregate*) {}
+
+        template<class P>
+        static void updateSubtreeAggregates(TreeNode<T, S, A>* root, P*) {
+            TreeNode<T, S, A>* node = root;
+            TreeNode<T, S, A>* from = (root == nullptr) ? nullptr : root->parent;
+            while(node != nullptr) {
+                if(from == node->parent && node->left != nullptr) { //came down - do the left subtree first
+                    from = node;
+                    node = node->left;
+                    continue;
+                }
+                if(from != node->right && node->right != nullptr) { //the left subtree is done - do the right one
+                    from = node;
+                    node = node->right;
+                    continue;
+                }
+                AVLTree::updateAggregate(node, static_cast<A*>(nullptr));
+                from = node;
+                node = (node == root) ? nullptr : node->parent;
+            }
+        }
+
         //calculate balance factor of a node
-        static int balanceFactor(const TreeNode<T, S>* node) {
+        static int balanceFactor(const TreeNode<T, S, A>* node) {
             if(node == nullptr) {
                 return 0;
             }
             return AVLTree::height(node->left) - AVLTree::height(node->right);
         }
 
-        //rebalance the tree using rotations
-        static TreeNode<T, S>* balanceTree(TreeNode<T, S>* root) {
+        //rebalance the subtree using rotations. returns the new root of the subtree
+        static TreeNode<T, S, A>* balanceTree(TreeNode<T, S, A>* root) {
             if(root == nullptr) {
                 return nullptr;
             }
-            root->height = AVLTree::height(root);
+            AVLTree::update(root);
             int balance = AVLTree::balanceFactor(root);
             if(balance == 2) {
                 if(AVLTree::balanceFactor(root->left) >= 0) { //Left Left Rotation
@@ -59,324 +123,856 @@ class AVLTree {
             }
             return root;
         }
-        
-        //A function for deleting a node from a BST tree, used later for remove
-        static TreeNode<T, S>* deleteNode(TreeNode<T, S>* root, const S& key){
-            if (root == nullptr){
-                return root;
-            }
 
-            if (key < root->key){
-                root->left = deleteNode(root->left, key);
+        //put newChild in oldChild's place under parent, or at the root if parent is nullptr
+        void replaceChild(TreeNode<T, S, A>* parent, TreeNode<T, S, A>* oldChild, TreeNode<T, S, A>* newChild) {
+            if(parent == nullptr) {
+                this->root = newChild;
             }
-
-            else if (key > root->key){
-                root->right = deleteNode(root->right, key);
+            else if(parent->left == oldChild) {
+                parent->left = newChild;
             }
+            else {
+                parent->right = newChild;
+            }
+            if(newChild != nullptr) {
+                newChild->parent = parent;
+            }
+        }
 
-            else{
-
-                if (root->left == nullptr && root->right == nullptr) {
-                    delete(root);
-                    return nullptr;
+        //walk up from node to the root, updating heights and rotating where needed.
+        //rebalancing stops as soon as a subtree keeps its height, since nothing above it can change;
+        //only the subtree sizes and aggregates are updated from there on
+        void rebalanceUp(TreeNode<T, S, A>* node) {
+            while(node != nullptr) {
+                int oldHeight = node->height;
+                TreeNode<T, S, A>* parent = node->parent;
+                TreeNode<T, S, A>* newRoot = AVLTree::balanceTree(node);
+                if(newRoot != node) {
+                    this->replaceChild(parent, node, newRoot);
                 }
-                
-                TreeNode<T, S>* temp;
-                if (root->left == nullptr) {
-                    temp = root;
-                    root = root->right;
-                    delete(temp);
-                    return root;
+                if(newRoot->height == oldHeight) {
+                    AVLTree::updateUp(parent);
+                    return;
                 }
+                node = parent;
+            }
+        }
 
-                if (root->right == nullptr) {
-                    temp = root;
-                    root = root->left;
-                    delete(temp);
-                    return root;
+        //rebalance every subtree on the way from node up to the top of its tree, which is returned
+        static TreeNode<T, S, A>* rebalanceToRoot(TreeNode<T, S, A>* node) {
+            TreeNode<T, S, A>* top = node;
+            while(node != nullptr) {
+                TreeNode<T, S, A>* parent = node->parent;
+                TreeNode<T, S, A>* newRoot = AVLTree::balanceTree(node);
+                if(parent != nullptr && newRoot != node) {
+                    if(parent->left == node) {
+                        parent->left = newRoot;
+                    }
+                    else {
+                        parent->right = newRoot;
+                    }
                 }
+                top = newRoot;
+                node = parent;
+            }
+            return top;
+        }
 
-                temp = minNode(root->right);
-                root->key = temp->key;
-                root->data = temp->data;
-                root->right = deleteNode(root->right, temp->key);
+        //join two detached subtrees with a detached pivot node, where every key of left < pivot's key < every key
+        //of right. the pivot is hung on the spine of the taller tree where the heights meet, so the cost is
+        //O(|height(left) - height(right)| + 1). returns the root of the joined tree
+        static TreeNode<T, S, A>* joinNodes(TreeNode<T, S, A>* left, TreeNode<T, S, A>* pivot, TreeNode<T, S, A>* right) {
+            int leftHeight = (left == nullptr) ? 0 : left->height;
+            int rightHeight = (right == nullptr) ? 0 : right->height;
+            TreeNode<T, S, A>* attachTo = nullptr;
+            if(leftHeight > rightHeight + 1) { //go down the right spine of left
+                TreeNode<T, S, A>* curr = left;
+                while(curr != nullptr && curr->height > rightHeight + 1) {
+                    attachTo = curr;
+                    curr = curr->right;
+                }
+                left = curr;
+            }
+            else if(rightHeight > leftHeight + 1) { //go down the left spine of right
+                TreeNode<T, S, A>* curr = right;
+                while(curr != nullptr && curr->height > leftHeight + 1) {
+                    attachTo = curr;
+                    curr = curr->left;
+                }
+                right = curr;
+            }
+            pivot->left = left;
+            pivot->right = right;
+            if(left != nullptr) {
+                left->parent = pivot;
             }
+            if(right != nullptr) {
+                right->parent = pivot;
+            }
+            AVLTree::update(pivot);
+            pivot->parent = attachTo;
+            if(attachTo == nullptr) {
+                return pivot;
+            }
+            if(leftHeight > rightHeight) {
+                attachTo->right = pivot;
+            }
+            else {
+                attachTo->left = pivot;
+            }
+            return AVLTree::rebalanceToRoot(attachTo);
+        }
 
-            return root;
+        //swap node with its successor in the tree structure, so that node ends up with no left son.
+        //the nodes themselves are relinked rather than their contents, so pointers to them stay valid
+        void swapWithSuccessor(TreeNode<T, S, A>* node) {
+            TreeNode<T, S, A>* succ = AVLTree::minNode(node->right);
+            TreeNode<T, S, A>* succParent = succ->parent;
+            TreeNode<T, S, A>* succRight = succ->right;
+            this->replaceChild(node->parent, node, succ);
+            succ->left = node->left;
+            succ->left->parent = succ;
+            if(succParent == node) {
+                succ->right = node;
+                node->parent = succ;
+            }
+            else {
+                succ->right = node->right;
+                succ->right->parent = succ;
+                succParent->left = node;
+                node->parent = succParent;
+            }
+            node->left = nullptr;
+            node->right = succRight;
+            if(succRight != nullptr) {
+                succRight->parent = node;
+            }
+            int height = node->height;
+            node->height = succ->height;
+            succ->height = height;
+            int size = node->size;
+            node->size = succ->size;
+            succ->size = size;
         }
-        
-        //return predecessor
-        static TreeNode<T, S>* minNode(TreeNode<T, S>* node) {
-            TreeNode<T, S>* current = node;
+
+        //return minimal node in the subtree
+        static TreeNode<T, S, A>* minNode(TreeNode<T, S, A>* node) {
+            TreeNode<T, S, A>* current = node;
             while (current->left != nullptr)
                 current = current->left;
             return current;
         }
 
-        //return successor
-        static TreeNode<T, S>* maxNode(TreeNode<T, S>* node) {
-            TreeNode<T, S>* current = node;
+        //return maximal node in the subtree
+        static TreeNode<T, S, A>* maxNode(TreeNode<T, S, A>* node) {
+            TreeNode<T, S, A>* current = node;
             while (current->right != nullptr)
                 current = current->right;
             return current;
         }
 
         //right right rotation
-        static TreeNode<T, S>* RRRotation(TreeNode<T, S>* root) {
-            TreeNode<T, S>* oldRoot = root;
-            TreeNode<T, S>* newRoot = root->right;
+        static TreeNode<T, S, A>* RRRotation(TreeNode<T, S, A>* root) {
+            TreeNode<T, S, A>* oldRoot = root;
+            TreeNode<T, S, A>* newRoot = root->right;
             oldRoot->right = newRoot->left;
+            if(oldRoot->right != nullptr) {
+                oldRoot->right->parent = oldRoot;
+            }
             newRoot->left = oldRoot;
-            oldRoot->height = height(oldRoot);
-            newRoot->height = height(newRoot);
+            newRoot->parent = oldRoot->parent;
+            oldRoot->parent = newRoot;
+            AVLTree::update(oldRoot);
+            AVLTree::update(newRoot);
             return newRoot;
         }
 
         //left left rotation
-        static TreeNode<T, S>* LLRotation(TreeNode<T, S>* root) {
-            TreeNode<T, S>* oldRoot = root;
-            TreeNode<T, S>* newRoot = root->left;
+        static TreeNode<T, S, A>* LLRotation(TreeNode<T, S, A>* root) {
+            TreeNode<T, S, A>* oldRoot = root;
+            TreeNode<T, S, A>* newRoot = root->left;
             oldRoot->left = newRoot->right;
+            if(oldRoot->left != nullptr) {
+                oldRoot->left->parent = oldRoot;
+            }
             newRoot->right = oldRoot;
-            oldRoot->height = height(oldRoot);
-            newRoot->height = height(newRoot);
+            newRoot->parent = oldRoot->parent;
+            oldRoot->parent = newRoot;
+            AVLTree::update(oldRoot);
+            AVLTree::update(newRoot);
             return newRoot;
         }
 
         //left right rotation
-        static TreeNode<T, S>* LRRotation(TreeNode<T, S>* root) {
-            TreeNode<T, S>* oldRoot = root;
-            TreeNode<T, S>* node = root->left;
-            TreeNode<T, S>* newRoot = root->left->right;
-            oldRoot->left = newRoot->right;
-            node->right = newRoot->left;
-            newRoot->right = oldRoot;
-            newRoot->left = node;
-            oldRoot->height = height(oldRoot);
-            node->height = height(node);
-            newRoot->height = height(newRoot);
-            return newRoot;
+        static TreeNode<T, S, A>* LRRotation(TreeNode<T, S, A>* root) {
+            root->left = AVLTree::RRRotation(root->left);
+            return AVLTree::LLRotation(root);
         }
 
         //right left rotation
-        static TreeNode<T, S>* RLRotation(TreeNode<T, S>* root) {
-            TreeNode<T, S>* oldRoot = root;
-            TreeNode<T, S>* node = root->right;
-            TreeNode<T, S>* newRoot = root->right->left;
-            oldRoot->right = newRoot->left;
-            node->left = newRoot->right;
-            newRoot->left = oldRoot;
-            newRoot->right = node;
-            oldRoot->height = height(oldRoot);
-            node->height = height(node);
-            newRoot->height = height(newRoot);
-            return newRoot;
+        static TreeNode<T, S, A>* RLRotation(TreeNode<T, S, A>* root) {
+            root->right = AVLTree::LLRotation(root->right);
+            return AVLTree::RRRotation(root);
         }
 
-        static TreeNode<T, S>* insertHelper(TreeNode<T, S>* root, shared_ptr<T> data, const S& key) {
-            if(root == nullptr) {
-                return new TreeNode<T, S>(data, key);
-            }
-            if(key < root->key) { //locate correct insertion position
-                root->left = insertHelper(root->left, data, key);
+        //write the nodes of both trees into arr in merged sorted order, walking the two trees side by side
+        static void mergeInOrder(TreeNode<T, S, A>* root1, TreeNode<T, S, A>* root2, TreeNode<T, S, A>* arr[]) {
+            TreeNode<T, S, A>* node1 = (root1 == nullptr) ? nullptr : AVLTree::minNode(root1);
+            TreeNode<T, S, A>* node2 = (root2 == nullptr) ? nullptr : AVLTree::minNode(root2);
+            int k = 0;
+            while (node1 != nullptr && node2 != nullptr) {
+                if (node1->key < node2->key) {
+                    arr[k++] = node1;
+                    node1 = AVLTree::next(node1);
+                }
+                else {
+                    arr[k++] = node2;
+                    node2 = AVLTree::next(node2);
+                }
             }
-            else if (key > root->key) { //REMOVE = LATER - DONT FORGET
-                root->right = insertHelper(root->right, data, key);
+            for (; node1 != nullptr; node1 = AVLTree::next(node1)) {
+                arr[k++] = node1;
             }
-            else { //same keys - illegal
-                throw AVLTree::KeyAlreadyExists();
+            for (; node2 != nullptr; node2 = AVLTree::next(node2)) {
+                arr[k++] = node2;
             }
-            return AVLTree::balanceTree(root);
-        }
-
-        static TreeNode<T, S>* removeHelper(TreeNode<T, S>* root, const S& key) {
-            return AVLTree::balanceTree(deleteNode(root, key));
         }
 
-        static TreeNode<T, S>* findHelper(TreeNode<T, S>* root, const S& key){
-            if (root == nullptr) {
-                throw AVLTree<T, S>::NodeNotFound();
+        //height of the tree sortedArrayToAVLTree builds out of size elements
+        static int builtHeight(int size) {
+            int height = 0;
+            while (size > 0) {
+                height++;
+                size /= 2;
             }
-
-            if (key < root->key){
-                return findHelper(root->left, key);
-            }
-
-            else if (key > root->key){
-                return findHelper(root->right, key);
-            }
-
-            return root;
+            return height;
         }
 
-        
-
-        static void mergeArrays(TreeNode<T, S> * arr1[], TreeNode<T, S> * arr2[], int arr1_size, int arr2_size, TreeNode<T, S> * arr3[]) {
-            int i = 0, j = 0, k = 0;
-            while (i < arr1_size && j < arr2_size) {
-                if (arr1[i]->key < arr2[j]->key) {
-                    arr3[k++] = arr1[i++];
+        //relink the nodes of arr[start..end] into a balanced tree, using an explicit stack of pending ranges.
+        //the nodes are reused as they are, nothing is allocated
+        static TreeNode<T, S, A>* sortedArrayToAVLTree(TreeNode<T, S, A> * arr[], int start, int end) {
+            struct Range {
+                int start;
+                int end;
+                TreeNode<T, S, A>* parent;
+                bool isLeft;
+            };
+            Range stack[2 * sizeof(int) * 8];
+            int top = 0;
+            TreeNode<T, S, A>* root = nullptr;
+            stack[top++] = {start, end, nullptr, false};
+            while (top > 0) {
+                Range range = stack[--top];
+                if (range.start > range.end) {
+                    if (range.parent != nullptr) {
+                        if (range.isLeft) {
+                            range.parent->left = nullptr;
+                        }
+                        else {
+                            range.parent->right = nullptr;
+                        }
+                    }
+                    continue;
+                }
+                int mid = (range.start + range.end)/2;
+                TreeNode<T, S, A>* node = arr[mid];
+                node->height = AVLTree::builtHeight(range.end - range.start + 1);
+                node->size = range.end - range.start + 1;
+                node->parent = range.parent;
+                if (range.parent == nullptr) {
+                    root = node;
+                }
+                else if (range.isLeft) {
+                    range.parent->left = node;
                 }
                 else {
-                    arr3[k++] = arr2[j++];
+                    range.parent->right = node;
                 }
+                stack[top++] = {mid + 1, range.end, node, false};
+                stack[top++] = {range.start, mid - 1, node, true};
             }
-            while (i < arr1_size) {
-                arr3[k++] = arr1[i++];
-            }
-            while (j < arr2_size) {
-                arr3[k++] = arr2[j++];
-            }
-
-            
-        }
-
-        static TreeNode<T, S>* sortedArrayToAVLTree(TreeNode<T, S> * arr[], int start, int end) {
-            if (start > end) {
-                return nullptr;
-            }
-            int mid = (start + end)/2;
-            TreeNode<T, S>* root = new TreeNode<T, S>();
-            root->data = shared_ptr<T>(arr[mid]->data);
-            root->key = arr[mid]->key;
-            TreeNode<T, S>* newLeft = sortedArrayToAVLTree(arr, start, mid - 1);
-            TreeNode<T, S>* newRight = sortedArrayToAVLTree(arr, mid + 1, end);
-            root->left = newLeft;
-            root->right = newRight;
             return root;
         }
 
+        NodePool<T, S, A>* pool;
+        bool ownsPool;
+
     public:
-        TreeNode<T, S>* root;
+        TreeNode<T, S, A>* root;
         int size;
         int getSize() const;
         AVLTree();
+        explicit AVLTree(NodePool<T, S, A>* pool);
         ~AVLTree();
-        void insert(shared_ptr<T> data, const S& key);
+        AVLTree(const AVLTree& other) = delete;
+        AVLTree& operator=(const AVLTree& other) = delete;
+        void insert(T* data, const S& key);
         void remove(const S& key);
-        TreeNode<T, S>* findNode(const S& key);
-        TreeNode<T, S>* findPredecessor(const S& key);
-        TreeNode<T, S>* findSuccessor(const S& key);
+        TreeNode<T, S, A>* findNode(const S& key);
+        TreeNode<T, S, A>* createNode(T* data, const S& key);
+        void destroyNode(TreeNode<T, S, A>* node);
+        TreeNode<T, S, A>* tryInsert(T* data, const S& key);
+        TreeNode<T, S, A>* tryInsert(T* data, const S& key, TreeNode<T, S, A>*& pre, TreeNode<T, S, A>*& succ);
+        bool tryRemove(const S& key);
+        bool link(TreeNode<T, S, A>* node);
+        bool link(TreeNode<T, S, A>* node, TreeNode<T, S, A>*& pre, TreeNode<T, S, A>*& succ);
+        TreeNode<T, S, A>* unlink(TreeNode<T, S, A>* node);
+        void clear(bool deleteData);
+        void join(AVLTree<T, S, A>& left, TreeNode<T, S, A>* pivot, AVLTree<T, S, A>& right);
+        TreeNode<T, S, A>* split(const S& key, AVLTree<T, S, A>& left, AVLTree<T, S, A>& right);
+        TreeNode<T, S, A>* tryFind(const S& key) const;
+        TreeNode<T, S, A>* findPredecessor(const S& key);
+        TreeNode<T, S, A>* findSuccessor(const S& key);
+        TreeNode<T, S, A>* lowerBound(const S& key) const;
+        TreeNode<T, S, A>* upperBound(const S& key) const;
+        int rank(const S& key) const;
+        TreeNode<T, S, A>* select(int k) const;
+        void refresh(TreeNode<T, S, A>* node);
+        typename A::Value aggregate(const S& low, const S& high) const;
+        static TreeNode<T, S, A>* next(TreeNode<T, S, A>* node);
+        static TreeNode<T, S, A>* prev(TreeNode<T, S, A>* node);
         class KeyAlreadyExists : public std::exception{};
         class NodeNotFound : public std::exception{};
 
-        static void merge(AVLTree<T, S> const &tree1, AVLTree<T, S> const &tree2, AVLTree<T, S> &merged) {
-            int arr1_size = tree1.getSize();
-            int arr2_size = tree2.getSize();
-            int arr3_size = arr1_size + arr2_size;
-            TreeNode<T, S>** arr1 = new TreeNode<T, S>* [arr1_size]; //first tree sorted array
-            TreeNode<T, S>** arr2 = new TreeNode<T, S>* [arr2_size]; //second tree sorted array
-            TreeNode<T, S>** arr3 = new TreeNode<T, S>* [arr3_size]; //sorted merged array of both trees
-            AVLTree::treeToArray(arr1, tree1.root, 0);
-            AVLTree::treeToArray(arr2, tree2.root, 0);
-            AVLTree::mergeArrays(arr1, arr2, arr1_size, arr2_size, arr3);
-            merged.root = sortedArrayToAVLTree(arr3, 0, arr3_size-1);
-            merged.size = arr3_size;
-            delete[] arr1;
-            delete[] arr2;
-            delete[] arr3;
-        }
-
-        //helper function for the D'CTOR
-        static void destruct(TreeNode<T, S>* node){
-            if (node != nullptr) {
-                destruct(node->left);
-                destruct(node->right);
-                if(node->data != nullptr) {
-                    node->data.reset();
+        //the size of the scratch array merging tree1 and tree2 needs: 0 if one is empty or their key ranges do not
+        //interleave, since those are merged without one. O(log n)
+        static int mergeScratchSize(const AVLTree<T, S, A> &tree1, const AVLTree<T, S, A> &tree2) {
+            if (tree1.root == nullptr || tree2.root == nullptr ||
+            AVLTree::maxNode(tree1.root)->key < AVLTree::minNode(tree2.root)->key ||
+            AVLTree::maxNode(tree2.root)->key < AVLTree::minNode(tree1.root)->key) {
+                return 0;
+            }
+            return tree1.getSize() + tree2.getSize();
+        }
+
+        //move the nodes of tree1 and tree2 into the empty tree merged, leaving both sources empty.
+        //trees with disjoint key ranges are joined in O(log n). otherwise the existing nodes are relinked into a
+        //balanced tree in O(n), using one scratch array of node pointers
+        //and no node allocations, so all three trees must allocate from the same pool.
+        //returns false, leaving every tree untouched, if the pools differ or the scratch array could not be allocated
+        static bool merge(AVLTree<T, S, A> &tree1, AVLTree<T, S, A> &tree2, AVLTree<T, S, A> &merged) {
+            if (tree1.pool != merged.pool || tree2.pool != merged.pool) {
+                return false;
+            }
+            int scratchSize = AVLTree::mergeScratchSize(tree1, tree2);
+            TreeNode<T, S, A>** scratch = nullptr;
+            if (scratchSize > 0) {
+                scratch = new (std::nothrow) TreeNode<T, S, A>* [scratchSize];
+                if (scratch == nullptr) {
+                    return false;
                 }
-                delete node;
             }
-            return;
+            AVLTree::merge(tree1, tree2, merged, scratch);
+            delete[] scratch;
+            return true;
         }
 
-        static int treeToArray(TreeNode<T, S>* array[], TreeNode<T, S>* root, int i) {
-            if(root == nullptr) {
-                return i;
+        //merge into a scratch array of mergeScratchSize(tree1, tree2) node pointers that the caller allocated,
+        //so a caller that merges several trees at once can reserve all of their memory first. cannot fail,
+        //but all three trees must allocate from the same pool
+        static void merge(AVLTree<T, S, A> &tree1, AVLTree<T, S, A> &tree2, AVLTree<T, S, A> &merged, TreeNode<T, S, A>* scratch[]) {
+            if (tree1.root == nullptr || tree2.root == nullptr) { //nothing to merge, just move the nodes
+                AVLTree<T, S, A>& full = (tree1.root == nullptr) ? tree2 : tree1;
+                merged.root = full.root;
+                merged.size = full.size;
+                full.root = nullptr;
+                full.size = 0;
+                return;
+            }
+            //if the key ranges do not interleave, join the trees around the smallest node of the higher one in O(log n)
+            AVLTree<T, S, A>* low = nullptr;
+            AVLTree<T, S, A>* high = nullptr;
+            if (AVLTree::maxNode(tree1.root)->key < AVLTree::minNode(tree2.root)->key) {
+                low = &tree1;
+                high = &tree2;
             }
-            if(root->left != nullptr) {
-                i = treeToArray(array, root->left, i);
+            else if (AVLTree::maxNode(tree2.root)->key < AVLTree::minNode(tree1.root)->key) {
+                low = &tree2;
+                high = &tree1;
             }
-            array[i] = root;
-            i++;
-            if(root->right != nullptr) {
-                i = treeToArray(array, root->right, i);
+            if (low != nullptr) {
+                TreeNode<T, S, A>* pivot = high->unlink(AVLTree::minNode(high->root));
+                merged.join(*low, pivot, *high);
+                return;
+            }
+            int mergedSize = tree1.getSize() + tree2.getSize();
+            AVLTree::mergeInOrder(tree1.root, tree2.root, scratch); //sorted nodes of both trees
+            merged.root = AVLTree::sortedArrayToAVLTree(scratch, 0, mergedSize - 1);
+            AVLTree::updateSubtreeAggregates(merged.root, static_cast<A*>(nullptr));
+            merged.size = mergedSize;
+            tree1.root = nullptr;
+            tree1.size = 0;
+            tree2.root = nullptr;
+            tree2.size = 0;
+        }
+
+        //helper function for the D'CTOR and clear. frees the nodes in post-order without recursion, detaching each
+        //leaf from its parent, and deletes the records too if deleteData is set. if the pool is private to the tree
+        //and about to be deleted, the nodes are only destructed here and their memory is released together with
+        //the pool's slabs. the hooks of an intrusive tree are left alone - they go with their records
+        static void destruct(NodePool<T, S, A>* pool, bool ownsPool, TreeNode<T, S, A>* node, bool deleteData){
+            while (node != nullptr) {
+                if (node->left != nullptr) {
+                    node = node->left;
+                }
+                else if (node->right != nullptr) {
+                    node = node->right;
+                }
+                else {
+                    TreeNode<T, S, A>* parent = node->parent;
+                    if (parent != nullptr) {
+                        if (parent->left == node) {
+                            parent->left = nullptr;
+                        }
+                        else {
+                            parent->right = nullptr;
+                        }
+                    }
+                    T* data = node->data;
+                    if(pool == nullptr) {
+                        //an intrusive node lives in its record
+                    }
+                    else if(ownsPool) {
+                        node->~TreeNode();
+                    }
+                    else {
+                        pool->destroy(node);
+                    }
+                    if(deleteData) {
+                        delete data;
+                    }
+                    node = parent;
+                }
             }
-            return i;
         }
 };
 
-template<class T, class S>
-AVLTree<T, S>::AVLTree(): 
+template<class T, class S, class A>
+AVLTree<T, S, A>::AVLTree():
+    pool(new NodePool<T, S, A>()),
+    ownsPool(true),
+    root(nullptr),
+    size(0)
+{}
+
+//a tree built on a shared pool; the pool must outlive the tree. without a pool the tree is intrusive
+template<class T, class S, class A>
+AVLTree<T, S, A>::AVLTree(NodePool<T, S, A>* pool):
+    pool(pool),
+    ownsPool(false),
     root(nullptr),
     size(0)
 {}
 
-template<class T, class S>
-int AVLTree<T, S>::getSize() const{
+template<class T, class S, class A>
+int AVLTree<T, S, A>::getSize() const{
     return this->size;
 }
 
-template<class T, class S>
-AVLTree<T, S>::~AVLTree() {
-    AVLTree::destruct(this->root);
+template<class T, class S, class A>
+AVLTree<T, S, A>::~AVLTree() {
+    AVLTree::destruct(this->pool, this->ownsPool, this->root, false);
+    if(this->ownsPool) {
+        delete this->pool;
+    }
+}
+
+template<class T, class S, class A>
+void AVLTree<T, S, A>::insert(T* data, const S& key) {
+    if(this->tryInsert(data, key) == nullptr) {
+        if(this->tryFind(key) != nullptr) {
+            throw AVLTree::KeyAlreadyExists();
+        }
+        throw std::bad_alloc();
+    }
+}
+
+template<class T, class S, class A>
+void AVLTree<T, S, A>::remove(const S& key) {
+    this->tryRemove(key);
 }
 
-template<class T, class S>
-void AVLTree<T, S>::insert(shared_ptr<T> data, const S& key) {
-    this->root = insertHelper(this->root, data, key);
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::findNode(const S& key){
+    TreeNode<T, S, A>* node = this->tryFind(key);
+    if(node == nullptr) {
+        throw AVLTree<T, S, A>::NodeNotFound();
+    }
+    return node;
+}
+
+//insert without throwing. returns the new node, or nullptr if the key already exists or the node could not be allocated
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::tryInsert(T* data, const S& key) {
+    TreeNode<T, S, A>* pre;
+    TreeNode<T, S, A>* succ;
+    return this->tryInsert(data, key, pre, succ);
+}
+
+//insert without throwing, also returning the in-order neighbors of the new node (nullptr where there is none).
+//returns nullptr if the key already exists or the node could not be allocated
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::tryInsert(T* data, const S& key, TreeNode<T, S, A>*& pre, TreeNode<T, S, A>*& succ) {
+    TreeNode<T, S, A>* node = this->createNode(data, key);
+    if(node == nullptr) {
+        return nullptr;
+    }
+    if(!this->link(node, pre, succ)) {
+        this->destroyNode(node);
+        return nullptr;
+    }
+    return node;
+}
+
+//a detached node from the tree's pool, for a caller that must allocate before it changes anything and link
+//later. returns nullptr if the node could not be allocated, or if the tree is intrusive and so makes no nodes
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::createNode(T* data, const S& key) {
+    if(this->pool == nullptr) {
+        return nullptr;
+    }
+    return this->pool->create(data, key);
+}
+
+//give a detached node from createNode back to the pool
+template<class T, class S, class A>
+void AVLTree<T, S, A>::destroyNode(TreeNode<T, S, A>* node) {
+    this->pool->destroy(node);
+}
+
+//put a detached node into the tree by its key. returns false, leaving the node detached, if the key already exists
+template<class T, class S, class A>
+bool AVLTree<T, S, A>::link(TreeNode<T, S, A>* node) {
+    TreeNode<T, S, A>* pre;
+    TreeNode<T, S, A>* succ;
+    return this->link(node, pre, succ);
+}
+
+//link, also returning the in-order neighbors of the node (nullptr where there is none).
+//a new node is always a leaf, so its neighbors are the last nodes the descent turned right and left at
+template<class T, class S, class A>
+bool AVLTree<T, S, A>::link(TreeNode<T, S, A>* node, TreeNode<T, S, A>*& pre, TreeNode<T, S, A>*& succ) {
+    TreeNode<T, S, A>* parent = nullptr;
+    TreeNode<T, S, A>* curr = this->root;
+    pre = nullptr;
+    succ = nullptr;
+    while(curr != nullptr) { //locate correct insertion position
+        parent = curr;
+        if(node->key < curr->key) {
+            succ = curr;
+            curr = curr->left;
+        }
+        else if(node->key > curr->key) {
+            pre = curr;
+            curr = curr->right;
+        }
+        else { //same keys - illegal
+            return false;
+        }
+    }
+    node->parent = parent;
+    AVLTree::update(node);
+    if(parent == nullptr) {
+        this->root = node;
+    }
+    else if(node->key < parent->key) {
+        parent->left = node;
+    }
+    else {
+        parent->right = node;
+    }
     this->size++;
+    this->rebalanceUp(parent);
+    return true;
+}
+
+//remove without throwing. returns false if the key is not in the tree
+template<class T, class S, class A>
+bool AVLTree<T, S, A>::tryRemove(const S& key) {
+    TreeNode<T, S, A>* node = this->tryFind(key);
+    if(node == nullptr) {
+        return false;
+    }
+    this->unlink(node);
+    if(this->pool != nullptr) {
+        this->pool->destroy(node);
+    }
+    return true;
 }
 
-template<class T, class S>
-void AVLTree<T, S>::remove(const S& key) {
-    this->root = removeHelper(this->root, key);
+//take node out of the tree without destroying it. returns the node, detached and ready to be linked elsewhere
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::unlink(TreeNode<T, S, A>* node) {
+    if(node->left != nullptr && node->right != nullptr) {
+        this->swapWithSuccessor(node);
+    }
+    TreeNode<T, S, A>* parent = node->parent;
+    this->replaceChild(parent, node, (node->left != nullptr) ? node->left : node->right);
     this->size--;
+    this->rebalanceUp(parent);
+    node->left = nullptr;
+    node->right = nullptr;
+    node->parent = nullptr;
+    AVLTree::update(node);
+    return node;
+}
+
+//remove every node. with deleteData the records are deleted as well, which for an intrusive tree is what
+//frees its nodes. O(n)
+template<class T, class S, class A>
+void AVLTree<T, S, A>::clear(bool deleteData) {
+    AVLTree::destruct(this->pool, false, this->root, deleteData);
+    this->root = nullptr;
+    this->size = 0;
 }
 
-template<class T, class S>
-TreeNode<T, S>* AVLTree<T, S>::findNode(const S& key){
-    return findHelper(this->root, key);
+//make this empty tree hold left, pivot and right, where every key of left < pivot's key < every key of right.
+//pivot is a detached node. left and right are left empty. all the trees must allocate from the same pool.
+//O(log n)
+template<class T, class S, class A>
+void AVLTree<T, S, A>::join(AVLTree<T, S, A>& left, TreeNode<T, S, A>* pivot, AVLTree<T, S, A>& right) {
+    this->root = AVLTree::joinNodes(left.root, pivot, right.root);
+    this->size = left.size + right.size + 1;
+    left.root = nullptr;
+    left.size = 0;
+    right.root = nullptr;
+    right.size = 0;
 }
 
-template<class T, class S>
-TreeNode<T, S>* AVLTree<T, S>::findPredecessor(const S& key){   // find predecessor of node. find node, if it has a left son, 
-    TreeNode <T, S>* node = AVLTree::findNode(key);             // find its max node and return it. otherwise, go back to the root
-    if (node->left != nullptr){                                 // and go down the tree - right if key is bigger than current node's 
-        return AVLTree<T, S>::maxNode(node->left);              // key and left otherwise.
+//move the keys smaller than key into the empty tree left and the bigger ones into the empty tree right,
+//leaving this tree empty. the node holding key itself, if there is one, is returned detached, otherwise
+//nullptr. all the trees must allocate from the same pool. O(log n)
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::split(const S& key, AVLTree<T, S, A>& left, AVLTree<T, S, A>& right) {
+    TreeNode<T, S, A>* found = nullptr;
+    TreeNode<T, S, A>* node = nullptr;
+    TreeNode<T, S, A>* curr = this->root;
+    while(curr != nullptr) {
+        node = curr;
+        if(key < curr->key) {
+            curr = curr->left;
+        }
+        else if(key > curr->key) {
+            curr = curr->right;
+        }
+        else {
+            found = curr;
+            break;
+        }
+    }
+    TreeNode<T, S, A>* smaller = nullptr;
+    TreeNode<T, S, A>* bigger = nullptr;
+    if(found != nullptr) {
+        smaller = found->left;
+        bigger = found->right;
+        node = found->parent;
+        found->left = nullptr;
+        found->right = nullptr;
+        found->parent = nullptr;
+        AVLTree::update(found);
+        if(smaller != nullptr) {
+            smaller->parent = nullptr;
+        }
+        if(bigger != nullptr) {
+            bigger->parent = nullptr;
+        }
+    }
+    //go back up the search path. every node on it joins the side it belongs to, together with its subtree
+    //that is off the path
+    while(node != nullptr) {
+        TreeNode<T, S, A>* parent = node->parent;
+        TreeNode<T, S, A>* offPath = (key < node->key) ? node->right : node->left;
+        if(offPath != nullptr) {
+            offPath->parent = nullptr;
+        }
+        node->left = nullptr;
+        node->right = nullptr;
+        node->parent = nullptr;
+        if(key < node->key) {
+            bigger = AVLTree::joinNodes(bigger, node, offPath);
+        }
+        else {
+            smaller = AVLTree::joinNodes(offPath, node, smaller);
+        }
+        node = parent;
     }
-    TreeNode<T, S>* curr = this->root;
-    TreeNode<T, S>* pre = nullptr;
+    left.root = smaller;
+    left.size = AVLTree::subtreeSize(smaller);
+    right.root = bigger;
+    right.size = AVLTree::subtreeSize(bigger);
+    this->root = nullptr;
+    this->size = 0;
+    return found;
+}
+
+//find without throwing. returns nullptr if the key is not in the tree
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::tryFind(const S& key) const{
+    TreeNode<T, S, A>* curr = this->root;
     while (curr != nullptr && key != curr->key) {
-        if (key > curr->key) {
-            pre = curr;
+        curr = (key < curr->key) ? curr->left : curr->right;
+    }
+    return curr;
+}
+
+//the first node with a key bigger than or equal to key, which need not be in the tree. nullptr if there is none.
+//together with next this walks the tree in order from any key without recursion. O(log n)
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::lowerBound(const S& key) const{
+    TreeNode<T, S, A>* bound = nullptr;
+    TreeNode<T, S, A>* curr = this->root;
+    while (curr != nullptr) {
+        if (curr->key < key) {
             curr = curr->right;
         }
-        else if (key < curr->key) {
+        else {
+            bound = curr;
             curr = curr->left;
         }
     }
-    return pre;
+    return bound;
 }
 
-template<class T, class S>
-TreeNode<T, S>* AVLTree<T, S>::findSuccessor(const S& key){ // find successor of node. similar to the predecessor's algorithm. 
-    TreeNode<T, S>* node = AVLTree::findNode(key);                       
-    if (node->right != nullptr) {                           
-        return AVLTree<T, S>::minNode(node->right);       
+//the first node with a key bigger than key, which need not be in the tree. nullptr if there is none. O(log n)
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::upperBound(const S& key) const{
+    TreeNode<T, S, A>* bound = nullptr;
+    TreeNode<T, S, A>* curr = this->root;
+    while (curr != nullptr) {
+        if (key < curr->key) {
+            bound = curr;
+            curr = curr->left;
+        }
+        else {
+            curr = curr->right;
+        }
     }
-    TreeNode<T, S>* curr = this->root;
-    TreeNode<T, S>* succ = nullptr;
-    while (curr != nullptr && key != curr->key) {
-        if (key < curr->key){
-            succ = curr;
+    return bound;
+}
+
+//the number of keys in the tree that are smaller than or equal to key; for a key in the tree this is its
+//position in ascending order, counting from 1
+template<class T, class S, class A>
+int AVLTree<T, S, A>::rank(const S& key) const{
+    int rank = 0;
+    TreeNode<T, S, A>* curr = this->root;
+    while (curr != nullptr) {
+        if (key < curr->key) {
             curr = curr->left;
         }
-        else if (key > curr->key){
+        else {
+            rank += AVLTree::subtreeSize(curr->left) + 1;
+            if (key == curr->key) {
+                break;
+            }
             curr = curr->right;
         }
     }
-    return succ;
+    return rank;
+}
+
+//the k-th smallest node, counting from 1. returns nullptr if k is out of range
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::select(int k) const{
+    if (k < 1 || k > this->size) {
+        return nullptr;
+    }
+    TreeNode<T, S, A>* curr = this->root;
+    while (curr != nullptr) {
+        int leftSize = AVLTree::subtreeSize(curr->left);
+        if (k <= leftSize) {
+            curr = curr->left;
+        }
+        else if (k == leftSize + 1) {
+            return curr;
+        }
+        else {
+            k -= leftSize + 1;
+            curr = curr->right;
+        }
+    }
+    return nullptr;
+}
+
+//recalculate the aggregates from node up to the root, after the record of node changed in a way its
+//aggregate policy measures. the key of node must not have changed. O(log n)
+template<class T, class S, class A>
+void AVLTree<T, S, A>::refresh(TreeNode<T, S, A>* node) {
+    AVLTree::updateUp(node);
+}
+
+//the aggregate of the records with keys in [low, high], combined in key order. O(log n):
+//below the node where the searches for low and high part, every subtree that lies wholly inside the range
+//contributes its stored aggregate
+template<class T, class S, class A>
+typename A::Value AVLTree<T, S, A>::aggregate(const S& low, const S& high) const{
+    TreeNode<T, S, A>* split = this->root;
+    while (split != nullptr && (split->key < low || split->key > high)) {
+        split = (split->key < low) ? split->right : split->left;
+    }
+    if (split == nullptr) {
+        return A::identity();
+    }
+    typename A::Value leftPart = A::identity();
+    for (TreeNode<T, S, A>* curr = split->left; curr != nullptr;) {
+        if (curr->key < low) {
+            curr = curr->right;
+        }
+        else {
+            leftPart = A::combine(A::combine(A::of(curr->data, curr->key), AVLTree::subtreeAggregate(curr->right)), leftPart);
+            curr = curr->left;
+        }
+    }
+    typename A::Value rightPart = A::identity();
+    for (TreeNode<T, S, A>* curr = split->right; curr != nullptr;) {
+        if (curr->key > high) {
+            curr = curr->left;
+        }
+        else {
+            rightPart = A::combine(rightPart, A::combine(AVLTree::subtreeAggregate(curr->left), A::of(curr->data, curr->key)));
+            curr = curr->right;
+        }
+    }
+    return A::combine(A::combine(leftPart, A::of(split->data, split->key)), rightPart);
+}
+
+//the node after node in in-order, or nullptr if it is the last. O(1) amortized over a traversal
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::next(TreeNode<T, S, A>* node){
+    if(node->right != nullptr) {
+        return AVLTree::minNode(node->right);
+    }
+    while(node->parent != nullptr && node->parent->right == node) {
+        node = node->parent;
+    }
+    return node->parent;
+}
+
+//the node before node in in-order, or nullptr if it is the first. O(1) amortized over a traversal
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::prev(TreeNode<T, S, A>* node){
+    if(node->left != nullptr) {
+        return AVLTree::maxNode(node->left);
+    }
+    while(node->parent != nullptr && node->parent->left == node) {
+        node = node->parent;
+    }
+    return node->parent;
+}
+
+//returns nullptr if the key is missing or has no predecessor
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::findPredecessor(const S& key){
+    TreeNode<T, S, A>* node = this->tryFind(key);
+    return (node == nullptr) ? nullptr : AVLTree::prev(node);
+}
+
+//returns nullptr if the key is missing or has no successor
+template<class T, class S, class A>
+TreeNode<T, S, A>* AVLTree<T, S, A>::findSuccessor(const S& key){
+    TreeNode<T, S, A>* node = this->tryFind(key);
+    return (node == nullptr) ? nullptr : AVLTree::next(node);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,89 @@
+#ifndef Aggregate_h
+#define Aggregate_h
+
+// Aggregate policies for AVLTree. A policy is a monoid over the records of a tree: every node keeps the
+// aggregate of its subtree, in key order, which lets the tree answer range queries in O(log n).
+// A policy provides
+//     typedef ... Value;
+//     static Value identity();
+//     static Value of(const T* data, const S& key);               the value of a single record
+//     static Value combine(const Value& left, const Value& right); associative, left before right in key order
+
+// The default policy. It keeps nothing, and the nodes take no room for it
+struct NoAggregate {
+    struct Value {};
+};
+
+// Holds a node's aggregate. Empty for NoAggregate, so a tree without an aggregate pays nothing for it
+template<class A>
+struct AggregateSlot {
+    typename A::Value aggregate;
+};
+
+template<>
+struct AggregateSlot<NoAggregate> {};
+
+// The number of records
+struct CountAggregate {
+    typedef int Value;
+
+    static Value identity() {
+        return 0;
+    }
+
+    template<class T, class S>
+    static Value of(const T* data, const S& key) {
+        return 1;
+    }
+
+    static Value combine(const Value& left, const Value& right) {
+        return left + right;
+    }
+};
+
+// The sum of a measure of the records
+template<class T, class V, V (T::*Measure)() const>
+struct SumAggregate {
+    typedef V Value;
+
+    static Value identity() {
+        return V();
+    }
+
+    template<class S>
+    static Value of(const T* data, const S& key) {
+        return (data->*Measure)();
+    }
+
+    static Value combine(const Value& left, const Value& right) {
+        return left + right;
+    }
+};
+
+// The record with the largest measure, the last one in key order on a tie. nullptr for no records.
+// V only needs operator<
+template<class T, class V, V (T::*Measure)() const>
+struct MaxAggregate {
+    typedef const T* Value;
+
+    static Value identity() {
+        return nullptr;
+    }
+
+    template<class S>
+    static Value of(const T* data, const S& key) {
+        return data;
+    }
+
+    static Value combine(const Value& left, const Value& right) {
+        if (right == nullptr) {
+            return left;
+        }
+        if (left == nullptr || !((right->*Measure)() < (left->*Measure)())) {
+            return right;
+        }
+        return left;
+    }
+};
+
+#endif
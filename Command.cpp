@@ -0,0 +1,45 @@
+#include "Command.h"
+
+static const char* const NAMES[Command::TYPES] = {
+    "add_team",
+    "remove_team",
+    "add_player",
+    "remove_player",
+    "update_player_stats",
+    "play_match",
+    "get_num_played_games",
+    "get_team_points",
+    "unite_teams",
+    "get_top_scorer",
+    "get_all_players_count",
+    "get_all_players",
+    "get_closest_player",
+    "knockout_winner",
+};
+
+//the int arguments of each command, not counting add_player's goalKeeper
+static const int ARG_COUNTS[Command::TYPES] = {2, 1, 5, 1, 4, 2, 1, 1, 3, 1, 1, 1, 2, 2};
+
+//the command's name in a command log
+const char* Command::name(CommandType type) {
+    return NAMES[static_cast<int>(type)];
+}
+
+int Command::argCount(CommandType type) {
+    return ARG_COUNTS[static_cast<int>(type)];
+}
+
+//whether the command returns an output_t<int> rather than a bare StatusType
+bool Command::hasAnswer(CommandType type) {
+    switch (type) {
+        case CommandType::GET_NUM_PLAYED_GAMES:
+        case CommandType::GET_TEAM_POINTS:
+        case CommandType::GET_TOP_SCORER:
+        case CommandType::GET_ALL_PLAYERS_COUNT:
+        case CommandType::GET_CLOSEST_PLAYER:
+        case CommandType::KNOCKOUT_WINNER:
+            return true;
+        default:
+            return false;
+    }
+}
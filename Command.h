@@ -0,0 +1,36 @@
+#ifndef Command_h
+#define Command_h
+
+// One world_cup_t operation, decoded from a command log. The arguments are the operation's int parameters in
+// the order of its signature; add_player's goalKeeper is the only bool parameter and has a field of its own.
+enum class CommandType : unsigned char {
+    ADD_TEAM,
+    REMOVE_TEAM,
+    ADD_PLAYER,
+    REMOVE_PLAYER,
+    UPDATE_PLAYER_STATS,
+    PLAY_MATCH,
+    GET_NUM_PLAYED_GAMES,
+    GET_TEAM_POINTS,
+    UNITE_TEAMS,
+    GET_TOP_SCORER,
+    GET_ALL_PLAYERS_COUNT,
+    GET_ALL_PLAYERS,
+    GET_CLOSEST_PLAYER,
+    KNOCKOUT_WINNER,
+};
+
+struct Command {
+    static const int MAX_ARGS = 5;
+    static const int TYPES = 14;
+
+    CommandType type;
+    bool goalKeeper;
+    int args[MAX_ARGS];
+
+    static const char* name(CommandType type);
+    static int argCount(CommandType type);
+    static bool hasAnswer(CommandType type);
+};
+
+#endif
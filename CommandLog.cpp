@@ -0,0 +1,66 @@
+#include "CommandLog.h"
+#include <cstring>
+
+//a NUL byte first, which a text log never has, then "WCL" and the format version
+const unsigned char CommandLog::MAGIC[CommandLog::MAGIC_SIZE] = {0, 'W', 'C', 'L', 1};
+
+static const unsigned char GOALKEEPER_BIT = 0x80;
+
+bool CommandLog::isBinary(const char* data, size_t size) {
+    return size >= MAGIC_SIZE && memcmp(data, MAGIC, MAGIC_SIZE) == 0;
+}
+
+//write the record of command to out, which has room for MAX_RECORD bytes. returns the bytes written
+int CommandLog::encode(const Command& command, unsigned char* out) {
+    int length = 0;
+    unsigned char opcode = static_cast<unsigned char>(command.type);
+    if (command.type == CommandType::ADD_PLAYER && command.goalKeeper) {
+        opcode |= GOALKEEPER_BIT;
+    }
+    out[length++] = opcode;
+    int args = Command::argCount(command.type);
+    for (int i = 0; i < args; i++) {
+        //zigzag maps small negative arguments to small codes too: 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+        unsigned int value = command.args[i];
+        unsigned int code = (value << 1) ^ (0u - (value >> 31));
+        while (code >= 0x80) {
+            out[length++] = static_cast<unsigned char>(code | 0x80);
+            code >>= 7;
+        }
+        out[length++] = static_cast<unsigned char>(code);
+    }
+    return length;
+}
+
+//read the record at data into command. returns the bytes read, or 0 if the record is malformed or cut off by end
+int CommandLog::decode(const unsigned char* data, const unsigned char* end, Command& command) {
+    const unsigned char* pos = data;
+    if (pos == end) {
+        return 0;
+    }
+    unsigned char opcode = *pos++;
+    int type = opcode & ~GOALKEEPER_BIT;
+    if (type >= Command::TYPES || ((opcode & GOALKEEPER_BIT) && type != static_cast<int>(CommandType::ADD_PLAYER))) {
+        return 0;
+    }
+    command.type = static_cast<CommandType>(type);
+    command.goalKeeper = (opcode & GOALKEEPER_BIT) != 0;
+    int args = Command::argCount(command.type);
+    for (int i = 0; i < args; i++) {
+        unsigned int code = 0;
+        int shift = 0;
+        while (true) {
+            if (pos == end || shift > 28) {
+                return 0;
+            }
+            unsigned char byte = *pos++;
+            code |= static_cast<unsigned int>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                break;
+            }
+            shift += 7;
+        }
+        command.args[i] = static_cast<int>((code >> 1) ^ (0u - (code & 1)));
+    }
+    return pos - data;
+}
@@ -0,0 +1,23 @@
+#ifndef CommandLog_h
+#define CommandLog_h
+
+#include "Command.h"
+#include <cstddef>
+
+// The binary command log format. A log starts with MAGIC, then holds one record per command:
+//     an opcode byte - the CommandType, with bit 7 set for an add_player whose player is a goalkeeper
+//     the command's int arguments, each zigzag encoded as a little endian base 128 varint
+// so a typical command takes 3 to 10 bytes instead of the 20 to 50 of its text line. CommandReader reads both
+// formats, telling them apart by MAGIC, which no text log can start with.
+class CommandLog {
+    public:
+        static const int MAGIC_SIZE = 5;
+        static const unsigned char MAGIC[MAGIC_SIZE];
+        static const int MAX_RECORD = 1 + Command::MAX_ARGS * 5;
+
+        static bool isBinary(const char* data, size_t size);
+        static int encode(const Command& command, unsigned char* out);
+        static int decode(const unsigned char* data, const unsigned char* end, Command& command);
+};
+
+#endif
@@ -0,0 +1,231 @@
+#include "CommandReader.h"
+#include "CommandLog.h"
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//the whitespace istream skips before a token
+static bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static int typeIf(const char* token, int length, CommandType type) {
+    return (memcmp(token, Command::name(type), length) == 0) ? static_cast<int>(type) : -1;
+}
+
+//the command named by token, or -1. the length and one character pick the only candidate
+static int commandType(const char* token, int length) {
+    switch(length) {
+        case 8:
+            return typeIf(token, length, CommandType::ADD_TEAM);
+        case 10:
+            return typeIf(token, length, (token[0] == 'a') ? CommandType::ADD_PLAYER : CommandType::PLAY_MATCH);
+        case 11:
+            return typeIf(token, length, (token[0] == 'r') ? CommandType::REMOVE_TEAM : CommandType::UNITE_TEAMS);
+        case 13:
+            return typeIf(token, length, CommandType::REMOVE_PLAYER);
+        case 14:
+            return typeIf(token, length, CommandType::GET_TOP_SCORER);
+        case 15:
+            if(token[0] == 'k') {
+                return typeIf(token, length, CommandType::KNOCKOUT_WINNER);
+            }
+            return typeIf(token, length, (token[4] == 't') ? CommandType::GET_TEAM_POINTS : CommandType::GET_ALL_PLAYERS);
+        case 18:
+            return typeIf(token, length, CommandType::GET_CLOSEST_PLAYER);
+        case 19:
+            return typeIf(token, length, CommandType::UPDATE_PLAYER_STATS);
+        case 20:
+            return typeIf(token, length, CommandType::GET_NUM_PLAYED_GAMES);
+        case 21:
+            return typeIf(token, length, CommandType::GET_ALL_PLAYERS_COUNT);
+        default:
+            return -1;
+    }
+}
+
+CommandReader::CommandReader():
+    data(nullptr),
+    end(nullptr),
+    pos(nullptr),
+    mappedSize(0),
+    buffer(nullptr),
+    token(nullptr),
+    tokenLength(0),
+    binary(false)
+{}
+
+CommandReader::~CommandReader() {
+    if(this->mappedSize != 0) {
+        munmap(const_cast<char*>(this->data), this->mappedSize);
+    }
+    free(this->buffer);
+}
+
+//read the commands of fd, mapping it if it is a regular file. returns false if it could not be read
+bool CommandReader::open(int fd) {
+    struct stat info;
+    if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapped != MAP_FAILED) {
+            madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+            this->mappedSize = info.st_size;
+            this->start(static_cast<const char*>(mapped), info.st_size);
+            return true;
+        }
+    }
+    return this->readAll(fd);
+}
+
+//read fd to its end into a buffer that doubles as it fills
+bool CommandReader::readAll(int fd) {
+    size_t capacity = 1 << 16;
+    size_t size = 0;
+    char* buffer = static_cast<char*>(malloc(capacity));
+    if(buffer == nullptr) {
+        return false;
+    }
+    while(true) {
+        if(size == capacity) {
+            char* bigger = static_cast<char*>(realloc(buffer, capacity * 2));
+            if(bigger == nullptr) {
+                free(buffer);
+                return false;
+            }
+            buffer = bigger;
+            capacity *= 2;
+        }
+        ssize_t got = read(fd, buffer + size, capacity - size);
+        if(got < 0) {
+            free(buffer);
+            return false;
+        }
+        if(got == 0) {
+            break;
+        }
+        size += got;
+    }
+    this->buffer = buffer;
+    this->start(buffer, size);
+    return true;
+}
+
+//read from the start of data, skipping the header of a binary log
+void CommandReader::start(const char* data, size_t size) {
+    this->data = data;
+    this->end = data + size;
+    this->pos = data;
+    this->binary = CommandLog::isBinary(data, size);
+    if (this->binary) {
+        this->pos += CommandLog::MAGIC_SIZE;
+    }
+}
+
+void CommandReader::skipSpace() {
+    while(this->pos != this->end && isSpace(*this->pos)) {
+        this->pos++;
+    }
+}
+
+//an optionally signed decimal int, as istream reads it. false if there is none or it overflows
+bool CommandReader::readInt(int& value) {
+    this->skipSpace();
+    bool negative = false;
+    if(this->pos != this->end && (*this->pos == '-' || *this->pos == '+')) {
+        negative = (*this->pos == '-');
+        this->pos++;
+    }
+    if(this->pos == this->end || *this->pos < '0' || *this->pos > '9') {
+        return false;
+    }
+    long long magnitude = 0;
+    long long limit = negative ? -static_cast<long long>(INT_MIN) : INT_MAX;
+    while(this->pos != this->end && *this->pos >= '0' && *this->pos <= '9') {
+        magnitude = magnitude * 10 + (*this->pos - '0');
+        if(magnitude > limit) {
+            return false;
+        }
+        this->pos++;
+    }
+    value = static_cast<int>(negative ? -magnitude : magnitude);
+    return true;
+}
+
+//true or false, as istream reads them with boolalpha
+bool CommandReader::readBool(bool& value) {
+    this->skipSpace();
+    size_t left = this->end - this->pos;
+    if(left >= 4 && memcmp(this->pos, "true", 4) == 0) {
+        value = true;
+        this->pos += 4;
+        return true;
+    }
+    if(left >= 5 && memcmp(this->pos, "false", 5) == 0) {
+        value = false;
+        this->pos += 5;
+        return true;
+    }
+    return false;
+}
+
+//decode the next record of a binary log. a corrupt record ends the log as an invalid format
+CommandReader::Status CommandReader::nextBinary(Command& command) {
+    if (this->pos == this->end) {
+        return Status::END;
+    }
+    const unsigned char* pos = reinterpret_cast<const unsigned char*>(this->pos);
+    int length = CommandLog::decode(pos, reinterpret_cast<const unsigned char*>(this->end), command);
+    if (length == 0) {
+        return Status::INVALID_FORMAT;
+    }
+    this->pos += length;
+    return Status::COMMAND;
+}
+
+//decode the next command into command
+CommandReader::Status CommandReader::next(Command& command) {
+    if (this->binary) {
+        return this->nextBinary(command);
+    }
+    this->skipSpace();
+    if(this->pos == this->end) {
+        return Status::END;
+    }
+    this->token = this->pos;
+    while(this->pos != this->end && !isSpace(*this->pos)) {
+        this->pos++;
+    }
+    this->tokenLength = this->pos - this->token;
+    int type = commandType(this->token, this->tokenLength);
+    if(type < 0) {
+        return Status::UNKNOWN_COMMAND;
+    }
+    command.type = static_cast<CommandType>(type);
+    command.goalKeeper = false;
+    int args = Command::argCount(command.type);
+    for(int i = 0; i < args; i++) {
+        if(!this->readInt(command.args[i])) {
+            return Status::INVALID_FORMAT;
+        }
+    }
+    if(command.type == CommandType::ADD_PLAYER && !this->readBool(command.goalKeeper)) {
+        return Status::INVALID_FORMAT;
+    }
+    return Status::COMMAND;
+}
+
+const char* CommandReader::getToken() const {
+    return this->token;
+}
+
+int CommandReader::getTokenLength() const {
+    return this->tokenLength;
+}
+
+bool CommandReader::isBinary() const {
+    return this->binary;
+}
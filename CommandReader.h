@@ -0,0 +1,50 @@
+#ifndef CommandReader_h
+#define CommandReader_h
+
+#include "Command.h"
+#include <cstddef>
+
+// Reads commands in the text format of main23a1, or in the binary format of CommandLog, straight out of memory.
+// A regular file is mapped with mmap and tokenized in place - no std::string or stream is involved - and
+// anything else, like a pipe, is read into one buffer first. Command names are looked up by their length and
+// a distinguishing character, then checked with a single memcmp.
+class CommandReader {
+    public:
+        enum class Status {
+            COMMAND, //command holds the next command
+            END, //no commands are left
+            UNKNOWN_COMMAND, //getToken holds a name that is not a command
+            INVALID_FORMAT, //the arguments of a command are missing or malformed
+        };
+
+    private:
+        const char* data;
+        const char* end;
+        const char* pos;
+        size_t mappedSize; //0 if data is a buffer of our own
+        char* buffer;
+        const char* token; //the last command name read
+        int tokenLength;
+        bool binary; //the input is a binary command log
+
+        void start(const char* data, size_t size);
+        Status nextBinary(Command& command);
+        void skipSpace();
+        bool readInt(int& value);
+        bool readBool(bool& value);
+        bool readAll(int fd);
+
+    public:
+        CommandReader();
+        ~CommandReader();
+        CommandReader(const CommandReader& other) = delete;
+        CommandReader& operator=(const CommandReader& other) = delete;
+
+        bool open(int fd);
+        Status next(Command& command);
+        const char* getToken() const;
+        int getTokenLength() const;
+        bool isBinary() const;
+};
+
+#endif
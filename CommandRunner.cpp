@@ -0,0 +1,50 @@
+#include "CommandRunner.h"
+#include <cstring>
+
+CommandRunner::CommandRunner(world_cup_t* world, OutputSink* out):
+    world(world),
+    out(out)
+{}
+
+//execute then format
+void CommandRunner::run(const Command& command) {
+    Result result;
+    this->execute(command, result);
+    this->format(result);
+}
+
+//run command on the world, without printing anything
+void CommandRunner::execute(const Command& command, Result& result) {
+    this->world->execute_batch(&command, 1, &result);
+}
+
+//print result the way main23a1 does, and free the ids it holds
+void CommandRunner::format(Result& result) {
+    if (!Command::hasAnswer(result.type)) {
+        this->out->writeLine(result.type, result.status);
+    }
+    else if (result.status == StatusType::SUCCESS) {
+        this->out->writeLine(result.type, output_t<int>(result.answer));
+    }
+    else {
+        this->out->writeLine(result.type, output_t<int>(result.status));
+    }
+    for (int i = 0; i < result.playerCount; ++i) {
+        this->out->writeIdLine(result.players[i]);
+    }
+    delete[] result.players;
+    result.players = nullptr;
+    result.playerCount = 0;
+}
+
+//main23a1's message for a command it does not know
+void CommandRunner::reportUnknownCommand(const char* name, int length) {
+    this->out->write("Unknown command: ", strlen("Unknown command: "));
+    this->out->write(name, length);
+    this->out->write("\n", 1);
+}
+
+//main23a1's message for missing or malformed arguments
+void CommandRunner::reportInvalidFormat() {
+    this->out->write("Invalid input format\n", strlen("Invalid input format\n"));
+}
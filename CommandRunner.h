@@ -0,0 +1,29 @@
+#ifndef CommandRunner_h
+#define CommandRunner_h
+
+#include "worldcup23a1.h"
+#include "Command.h"
+#include "OutputSink.h"
+#include "Result.h"
+
+// Runs decoded commands on a world and prints their results the way main23a1 does. Running a command is split
+// into execute, which only touches the world, and format, which only touches the output, so a driver can
+// do the two on different threads.
+class CommandRunner {
+    private:
+        world_cup_t* world;
+        OutputSink* out;
+
+    public:
+        CommandRunner(world_cup_t* world, OutputSink* out);
+        CommandRunner(const CommandRunner& other) = delete;
+        CommandRunner& operator=(const CommandRunner& other) = delete;
+
+        void run(const Command& command);
+        void execute(const Command& command, Result& result);
+        void format(Result& result);
+        void reportUnknownCommand(const char* name, int length);
+        void reportInvalidFormat();
+};
+
+#endif
@@ -0,0 +1,201 @@
+#include "Knockout.h"
+#include <new>
+#include <thread>
+#include <pthread.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//a knockout using as many threads as the machine has cores, up to MAX_THREADS
+Knockout::Knockout():
+    Knockout(static_cast<int>(std::thread::hardware_concurrency()))
+{}
+
+//a knockout splitting wide rounds between up to threads threads. 1 or less plays every round on the calling thread
+Knockout::Knockout(int threads):
+    ids(nullptr),
+    scores(nullptr),
+    nextIds(nullptr),
+    nextScores(nullptr),
+    count(0),
+    capacity(0),
+    threads((threads > MAX_THREADS) ? MAX_THREADS : threads)
+{}
+
+Knockout::~Knockout() {
+    delete[] this->ids;
+    delete[] this->scores;
+    delete[] this->nextIds;
+    delete[] this->nextScores;
+}
+
+//make room for capacity teams, keeping the ones already added, so that adding them allocates nothing.
+//returns false if out of memory
+bool Knockout::reserve(int capacity) {
+    if (capacity <= this->capacity) {
+        return true;
+    }
+    int* newIds = new (std::nothrow) int[capacity];
+    int* newScores = new (std::nothrow) int[capacity];
+    int* newNextIds = new (std::nothrow) int[capacity / 2 + 1];
+    int* newNextScores = new (std::nothrow) int[capacity / 2 + 1];
+    if (newIds == nullptr || newScores == nullptr || newNextIds == nullptr || newNextScores == nullptr) {
+        delete[] newIds;
+        delete[] newScores;
+        delete[] newNextIds;
+        delete[] newNextScores;
+        return false;
+    }
+    for (int i = 0; i < this->count; i++) {
+        newIds[i] = this->ids[i];
+        newScores[i] = this->scores[i];
+    }
+    delete[] this->ids;
+    delete[] this->scores;
+    delete[] this->nextIds;
+    delete[] this->nextScores;
+    this->ids = newIds;
+    this->scores = newScores;
+    this->nextIds = newNextIds;
+    this->nextScores = newNextScores;
+    this->capacity = capacity;
+    return true;
+}
+
+//forget the teams of the last knockout, keeping the memory
+void Knockout::clear() {
+    this->count = 0;
+}
+
+//add the next team in id order. returns false if out of memory
+bool Knockout::add(int teamId, int score) {
+    if (this->count == this->capacity && !this->reserve((this->capacity == 0) ? 16 : this->capacity * 2)) {
+        return false;
+    }
+    this->ids[this->count] = teamId;
+    this->scores[this->count] = score;
+    this->count++;
+    return true;
+}
+
+int Knockout::getCount() const {
+    return this->count;
+}
+
+//play the first pairs pairs of teams, writing the winner of pair i to index i. the higher score wins, a tie goes
+//to the higher id, and the winner adds the loser's score and 3 points to its own, wrapping around on overflow
+void Knockout::playRound(const int* ids, const int* scores, int pairs, int* winnerIds, int* winnerScores) {
+    int i = 0;
+#if defined(__AVX2__)
+    const __m256i three = _mm256_set1_epi32(3);
+    for (; i + 8 <= pairs; i += 8) {
+        //split 16 teams into the 8 first and 8 second teams of their pairs. the shuffle works within 128 bit
+        //lanes, so the 64 bit quarters are put back in order after it
+        __m256 lowScores = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(scores + 2 * i)));
+        __m256 highScores = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(scores + 2 * i + 8)));
+        __m256 lowIds = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + 2 * i)));
+        __m256 highIds = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + 2 * i + 8)));
+        __m256i firstScores = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(lowScores, highScores, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i secondScores = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(lowScores, highScores, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i firstIds = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(lowIds, highIds, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i secondIds = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(lowIds, highIds, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i firstWins = _mm256_or_si256(_mm256_cmpgt_epi32(firstScores, secondScores),
+            _mm256_and_si256(_mm256_cmpeq_epi32(firstScores, secondScores), _mm256_cmpgt_epi32(firstIds, secondIds)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(winnerIds + i), _mm256_blendv_epi8(secondIds, firstIds, firstWins));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(winnerScores + i), _mm256_add_epi32(_mm256_add_epi32(firstScores, secondScores), three));
+    }
+#elif defined(__SSE2__)
+    const __m128i three = _mm_set1_epi32(3);
+    for (; i + 4 <= pairs; i += 4) {
+        //split 8 teams into the 4 first and 4 second teams of their pairs
+        __m128 lowScores = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(scores + 2 * i)));
+        __m128 highScores = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(scores + 2 * i + 4)));
+        __m128 lowIds = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + 2 * i)));
+        __m128 highIds = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + 2 * i + 4)));
+        __m128i firstScores = _mm_castps_si128(_mm_shuffle_ps(lowScores, highScores, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i secondScores = _mm_castps_si128(_mm_shuffle_ps(lowScores, highScores, _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128i firstIds = _mm_castps_si128(_mm_shuffle_ps(lowIds, highIds, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i secondIds = _mm_castps_si128(_mm_shuffle_ps(lowIds, highIds, _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128i firstWins = _mm_or_si128(_mm_cmpgt_epi32(firstScores, secondScores),
+            _mm_and_si128(_mm_cmpeq_epi32(firstScores, secondScores), _mm_cmpgt_epi32(firstIds, secondIds)));
+        __m128i winner = _mm_or_si128(_mm_and_si128(firstWins, firstIds), _mm_andnot_si128(firstWins, secondIds));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(winnerIds + i), winner);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(winnerScores + i), _mm_add_epi32(_mm_add_epi32(firstScores, secondScores), three));
+    }
+#endif
+    for (; i < pairs; i++) {
+        int first = 2 * i;
+        int second = first + 1;
+        bool firstWins = scores[first] > scores[second] || (scores[first] == scores[second] && ids[first] > ids[second]);
+        winnerIds[i] = firstWins ? ids[first] : ids[second];
+        //added as unsigned so an overflow wraps like the vector lanes do, instead of being undefined
+        winnerScores[i] = static_cast<int>(static_cast<unsigned>(scores[first]) + static_cast<unsigned>(scores[second]) + 3u);
+    }
+}
+
+//playRound on a chunk, with the signature pthread_create expects
+void* Knockout::playChunk(void* chunk) {
+    Chunk* round = static_cast<Chunk*>(chunk);
+    Knockout::playRound(round->ids, round->scores, round->pairs, round->winnerIds, round->winnerScores);
+    return nullptr;
+}
+
+//playRound with the pairs split into one contiguous chunk per thread. the calling thread plays the last chunk,
+//and also any chunk whose thread could not be started. the threads are started with pthread_create, which
+//reports a failure through its return value, so the library still builds without exceptions
+void Knockout::playRoundInParallel(const int* ids, const int* scores, int pairs, int* winnerIds, int* winnerScores) {
+    pthread_t workers[MAX_THREADS];
+    bool started[MAX_THREADS] = {};
+    Chunk chunks[MAX_THREADS];
+    int chunk = (pairs + this->threads - 1) / this->threads;
+    int begin = 0;
+    for (int t = 0; t < this->threads - 1 && begin < pairs; t++) {
+        int size = (pairs - begin < chunk) ? pairs - begin : chunk;
+        chunks[t] = Chunk{ids + 2 * begin, scores + 2 * begin, size, winnerIds + begin, winnerScores + begin};
+        started[t] = (pthread_create(&workers[t], nullptr, Knockout::playChunk, &chunks[t]) == 0);
+        if (!started[t]) {
+            Knockout::playChunk(&chunks[t]);
+        }
+        begin += size;
+    }
+    Knockout::playRound(ids + 2 * begin, scores + 2 * begin, pairs - begin, winnerIds + begin, winnerScores + begin);
+    for (int t = 0; t < this->threads - 1; t++) {
+        if (started[t]) {
+            pthread_join(workers[t], nullptr);
+        }
+    }
+}
+
+//play rounds until one team is left and return its id. in every round the teams meet in pairs by id order,
+//with the last one resting if their number is odd. there must be at least one team
+int Knockout::play() {
+    int* ids = this->ids;
+    int* scores = this->scores;
+    int* winnerIds = this->nextIds;
+    int* winnerScores = this->nextScores;
+    int alive = this->count;
+    while (alive > 1) {
+        int pairs = alive / 2;
+        if (this->threads > 1 && pairs >= PARALLEL_PAIRS) {
+            this->playRoundInParallel(ids, scores, pairs, winnerIds, winnerScores);
+        }
+        else {
+            Knockout::playRound(ids, scores, pairs, winnerIds, winnerScores);
+        }
+        if (alive % 2 == 1) {
+            winnerIds[pairs] = ids[alive - 1];
+            winnerScores[pairs] = scores[alive - 1];
+        }
+        alive = pairs + alive % 2;
+        //the winners are the next round's teams. after the first round both pairs of arrays have room for them
+        int* temp = ids;
+        ids = winnerIds;
+        winnerIds = temp;
+        temp = scores;
+        scores = winnerScores;
+        winnerScores = temp;
+    }
+    return ids[0];
+}
@@ -0,0 +1,51 @@
+#ifndef Knockout_h
+#define Knockout_h
+
+// The scratch space of knockout_winner. The teams in range are copied into contiguous arrays of ids and
+// match scores, and every round writes its winners into a second pair of arrays, which then become the
+// input of the next round. The arrays only grow and are kept between knockouts, so once they are big
+// enough for the largest range a knockout allocates nothing.
+// A round is played by a vectorized kernel (AVX2 when built with -mavx2, SSE2 otherwise, scalar where
+// neither is available), and rounds of at least PARALLEL_PAIRS pairs are split between threads. The
+// winner is the same in every case.
+class Knockout {
+    private:
+        static const int PARALLEL_PAIRS = 1 << 16;
+        static const int MAX_THREADS = 8;
+
+        int* ids;
+        int* scores;
+        int* nextIds;
+        int* nextScores;
+        int count;
+        int capacity;
+        int threads;
+
+        //the part of a round one thread plays
+        struct Chunk {
+            const int* ids;
+            const int* scores;
+            int pairs;
+            int* winnerIds;
+            int* winnerScores;
+        };
+
+        static void playRound(const int* ids, const int* scores, int pairs, int* winnerIds, int* winnerScores);
+        static void* playChunk(void* chunk);
+        void playRoundInParallel(const int* ids, const int* scores, int pairs, int* winnerIds, int* winnerScores);
+
+    public:
+        Knockout();
+        explicit Knockout(int threads);
+        ~Knockout();
+        Knockout(const Knockout& other) = delete;
+        Knockout& operator=(const Knockout& other) = delete;
+
+        bool reserve(int capacity);
+        void clear();
+        bool add(int teamId, int score);
+        int getCount() const;
+        int play();
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include "KnockoutCache.h"
+
+KnockoutCache::KnockoutCache():
+    stores(0)
+{
+    for (int i = 0; i < SIZE; i++) {
+        this->entries[i].valid = false;
+        this->entries[i].stamp = 0;
+    }
+}
+
+//the cached winner of the range, if there is one. returns false otherwise
+bool KnockoutCache::find(int minTeamId, int maxTeamId, int& winner) const {
+    for (int i = 0; i < SIZE; i++) {
+        const Entry& entry = this->entries[i];
+        if (entry.valid && entry.minTeamId == minTeamId && entry.maxTeamId == maxTeamId) {
+            winner = entry.winner;
+            return true;
+        }
+    }
+    return false;
+}
+
+//remember the winner of a range, in a free entry if there is one and in place of the oldest otherwise
+void KnockoutCache::store(int minTeamId, int maxTeamId, int winner) {
+    Entry* slot = &this->entries[0];
+    for (int i = 0; i < SIZE && slot->valid; i++) {
+        Entry& entry = this->entries[i];
+        if (!entry.valid || entry.stamp < slot->stamp) {
+            slot = &entry;
+        }
+    }
+    slot->minTeamId = minTeamId;
+    slot->maxTeamId = maxTeamId;
+    slot->winner = winner;
+    slot->valid = true;
+    slot->stamp = this->stores++;
+}
+
+//drop the results of every range holding teamId
+void KnockoutCache::invalidate(int teamId) {
+    for (int i = 0; i < SIZE; i++) {
+        Entry& entry = this->entries[i];
+        if (entry.valid && entry.minTeamId <= teamId && teamId <= entry.maxTeamId) {
+            entry.valid = false;
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef KnockoutCache_h
+#define KnockoutCache_h
+
+// Remembers the results of the last few knockout_winner queries by their (minTeamId, maxTeamId) range.
+// A result stays valid until a kosher team inside its range changes its match score, or a team inside it
+// joins or leaves the kosher teams - the world reports both with invalidate. Looking up a result or
+// dropping the ones a team affects costs O(SIZE), independent of the number of teams.
+class KnockoutCache {
+    private:
+        static const int SIZE = 16;
+
+        struct Entry {
+            int minTeamId;
+            int maxTeamId;
+            int winner; //0 if the range holds no kosher team
+            bool valid;
+            unsigned long long stamp; //when the entry was stored, so the oldest can be found
+        };
+
+        Entry entries[SIZE];
+        unsigned long long stores; //the stamp of the next store
+
+    public:
+        KnockoutCache();
+        ~KnockoutCache() = default;
+        KnockoutCache(const KnockoutCache& other) = delete;
+        KnockoutCache& operator=(const KnockoutCache& other) = delete;
+
+        bool find(int minTeamId, int maxTeamId, int& winner) const;
+        void store(int minTeamId, int maxTeamId, int winner);
+        void invalidate(int teamId);
+};
+
+#endif
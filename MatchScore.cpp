@@ -0,0 +1,11 @@
+#include "MatchScore.h"
+
+MatchScore::MatchScore(int score, int teamId):
+    score(score),
+    teamId(teamId)
+{}
+
+MatchScore::MatchScore():
+    score(),
+    teamId()
+{}
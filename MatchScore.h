@@ -0,0 +1,31 @@
+#ifndef MatchScore_h
+#define MatchScore_h
+
+// The key of a team in the league table: its match score, and its id to break ties the way a knockout does,
+// so the higher id counts as the better team.
+class MatchScore {
+    public:
+        int score;
+        int teamId;
+
+        MatchScore(int score, int teamId);
+        MatchScore();
+
+        friend bool operator<(const MatchScore& l, const MatchScore& r) {
+            return l.score < r.score || (l.score == r.score && l.teamId < r.teamId);
+        }
+
+        friend bool operator>(const MatchScore& l, const MatchScore& r) {
+            return (r < l);
+        }
+
+        friend bool operator==(const MatchScore& l, const MatchScore& r) {
+            return l.score == r.score && l.teamId == r.teamId;
+        }
+
+        friend bool operator!=(const MatchScore& l, const MatchScore& r) {
+            return !(l == r);
+        }
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef NodePool_h
+#define NodePool_h
+
+#include "TreeNode.h"
+#include <new>
+#include <utility>
+
+// A slab allocator. Objects are carved out of fixed size slabs and recycled through a free list, so
+// creating or destroying an object is O(1), and deleting the pool hands all of its slabs back at once.
+// The owner of a pool holds plain pointers into it - the pool never counts references.
+template<class T>
+class ObjectPool {
+        static const int SLAB_SIZE = 128;
+
+        union Block {
+            Block* next;
+            alignas(T) char storage[sizeof(T)];
+        };
+
+        struct Slab {
+            Slab* next;
+            Block blocks[SLAB_SIZE];
+        };
+
+        Slab* slabs;
+        Block* freeList;
+        int used; //blocks handed out from the newest slab
+
+        //get a raw block, from the free list if possible and from the current slab otherwise.
+        //returns nullptr if a new slab was needed and could not be allocated
+        void* allocate() {
+            if(this->freeList != nullptr) {
+                Block* block = this->freeList;
+                this->freeList = block->next;
+                return block;
+            }
+            if(this->slabs == nullptr || this->used == SLAB_SIZE) {
+                Slab* slab = new (std::nothrow) Slab;
+                if(slab == nullptr) {
+                    return nullptr;
+                }
+                slab->next = this->slabs;
+                this->slabs = slab;
+                this->used = 0;
+            }
+            return &this->slabs->blocks[this->used++];
+        }
+
+    public:
+        ObjectPool();
+        ~ObjectPool();
+        ObjectPool(const ObjectPool& other) = delete;
+        ObjectPool& operator=(const ObjectPool& other) = delete;
+
+        template<class... Args>
+        T* create(Args&&... args);
+        void destroy(T* object);
+};
+
+template<class T>
+ObjectPool<T>::ObjectPool():
+    slabs(nullptr),
+    freeList(nullptr),
+    used(0)
+{}
+
+//releases the memory of every slab. objects still alive are not destructed - the owner must destruct them first
+template<class T>
+ObjectPool<T>::~ObjectPool() {
+    while(this->slabs != nullptr) {
+        Slab* next = this->slabs->next;
+        delete this->slabs;
+        this->slabs = next;
+    }
+}
+
+//construct an object from args. returns nullptr if out of memory
+template<class T>
+template<class... Args>
+T* ObjectPool<T>::create(Args&&... args) {
+    void* block = this->allocate();
+    if(block == nullptr) {
+        return nullptr;
+    }
+    return new (block) T(std::forward<Args>(args)...);
+}
+
+template<class T>
+void ObjectPool<T>::destroy(T* object) {
+    object->~T();
+    Block* block = reinterpret_cast<Block*>(object);
+    block->next = this->freeList;
+    this->freeList = block;
+}
+
+// A pool of tree nodes. It may belong to a single tree or be shared by several trees of the same type.
+template<class T, class S, class A = NoAggregate>
+using NodePool = ObjectPool<TreeNode<T, S, A>>;
+
+#endif
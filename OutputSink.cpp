@@ -0,0 +1,119 @@
+#include "OutputSink.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+static const char* const STATUS_NAMES[] = {
+    "SUCCESS",
+    "ALLOCATION_ERROR",
+    "INVALID_INPUT",
+    "FAILURE"
+};
+
+//the buffer is allocated here once, and every prefix is formatted once
+OutputSink::OutputSink(int fd):
+    fd(fd),
+    buffer(new char[BUFFER_SIZE]),
+    used(0),
+    failed(false)
+{
+    for (int type = 0; type < Command::TYPES; type++) {
+        for (int status = 0; status < STATUSES; status++) {
+            Prefix& prefix = this->prefixes[type][status];
+            const char* name = Command::name(static_cast<CommandType>(type));
+            int nameLength = strlen(name);
+            int statusLength = strlen(STATUS_NAMES[status]);
+            memcpy(prefix.text, name, nameLength);
+            memcpy(prefix.text + nameLength, ": ", 2);
+            memcpy(prefix.text + nameLength + 2, STATUS_NAMES[status], statusLength);
+            prefix.length = nameLength + 2 + statusLength;
+        }
+    }
+}
+
+OutputSink::~OutputSink() {
+    this->flush();
+    delete[] this->buffer;
+}
+
+//make room for length more bytes, writing the buffer out if it is too full. length is at most BUFFER_SIZE
+void OutputSink::reserve(int length) {
+    if (this->used + length > BUFFER_SIZE) {
+        this->flush();
+    }
+}
+
+void OutputSink::write(const char* text, int length) {
+    while (length > 0) {
+        int chunk = (length < BUFFER_SIZE) ? length : BUFFER_SIZE;
+        this->reserve(chunk);
+        memcpy(this->buffer + this->used, text, chunk);
+        this->used += chunk;
+        text += chunk;
+        length -= chunk;
+    }
+}
+
+//value in decimal, as an ostream prints it
+void OutputSink::writeInt(int value) {
+    char digits[12];
+    int start = sizeof(digits);
+    unsigned int magnitude = (value < 0) ? 0u - static_cast<unsigned int>(value) : value;
+    do {
+        digits[--start] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        digits[--start] = '-';
+    }
+    this->write(digits + start, sizeof(digits) - start);
+}
+
+//"command: STATUS"
+void OutputSink::writeLine(CommandType type, StatusType status) {
+    const Prefix& prefix = this->prefixes[static_cast<int>(type)][static_cast<int>(status)];
+    this->reserve(prefix.length + 1);
+    memcpy(this->buffer + this->used, prefix.text, prefix.length);
+    this->used += prefix.length;
+    this->buffer[this->used++] = '\n';
+}
+
+//"command: SUCCESS, answer", or "command: STATUS" for a failure
+void OutputSink::writeLine(CommandType type, output_t<int> result) {
+    if (result.status() != StatusType::SUCCESS) {
+        this->writeLine(type, result.status());
+        return;
+    }
+    const Prefix& prefix = this->prefixes[static_cast<int>(type)][static_cast<int>(StatusType::SUCCESS)];
+    this->reserve(prefix.length + 2);
+    memcpy(this->buffer + this->used, prefix.text, prefix.length);
+    this->used += prefix.length;
+    this->buffer[this->used++] = ',';
+    this->buffer[this->used++] = ' ';
+    this->writeInt(result.ans());
+    this->write("\n", 1);
+}
+
+//one id of get_all_players on its own line
+void OutputSink::writeIdLine(int id) {
+    this->writeInt(id);
+    this->write("\n", 1);
+}
+
+//write out everything buffered. returns false if a write failed now or earlier
+bool OutputSink::flush() {
+    int done = 0;
+    while (!this->failed && done < this->used) {
+        ssize_t written = ::write(this->fd, this->buffer + done, this->used - done);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            this->failed = true;
+            break;
+        }
+        done += written;
+    }
+    this->used = 0;
+    return !this->failed;
+}
@@ -0,0 +1,44 @@
+#ifndef OutputSink_h
+#define OutputSink_h
+
+#include "Command.h"
+#include "wet1util.h"
+#include <cstddef>
+
+// Formats the driver's output lines into one large buffer and writes it to a file descriptor in big chunks,
+// with no flush per line. The "command: STATUS" prefix of every command and status is formatted once up front,
+// and ints are converted by hand into the buffer. The bytes written are exactly those main23a1 prints.
+class OutputSink {
+    private:
+        static const int BUFFER_SIZE = 1 << 20;
+        static const int STATUSES = 4;
+        static const int MAX_PREFIX = 48;
+
+        struct Prefix {
+            char text[MAX_PREFIX];
+            int length;
+        };
+
+        int fd;
+        char* buffer;
+        int used;
+        bool failed; //a write failed, and the rest of the output is dropped
+        Prefix prefixes[Command::TYPES][STATUSES];
+
+        void reserve(int length);
+
+    public:
+        explicit OutputSink(int fd);
+        ~OutputSink();
+        OutputSink(const OutputSink& other) = delete;
+        OutputSink& operator=(const OutputSink& other) = delete;
+
+        void write(const char* text, int length);
+        void writeInt(int value);
+        void writeLine(CommandType type, StatusType status);
+        void writeLine(CommandType type, output_t<int> result);
+        void writeIdLine(int id);
+        bool flush();
+};
+
+#endif
@@ -1,24 +1,23 @@
 #include "Player.h"
 
-Player::Player(int id, int teamId, shared_ptr<Team> team, int gamesPlayed, int goals, int cards, bool goalKeeper):
+Player::Player(int id, TeamSet* teamSet, int gamesPlayed, int goals, int cards, bool goalKeeper):
     id(id), 
-    teamId(teamId), 
-    team(team),
+    teamSet(teamSet),
     gamesPlayed(gamesPlayed),
     goals(goals), 
     cards(cards), 
     goalKeeper(goalKeeper),
-    pre(nullptr),
-    succ(nullptr)
-{}
+    idNode(this, id),
+    statsNode(this, Stats(goals, cards, id)),
+    teamIdNode(this, id),
+    teamStatsNode(this, Stats(goals, cards, id))
+{
+    this->teamSet->acquire();
+}
 
 Player::~Player(){
-    this->succ.reset();
-    this->pre.reset();
-    this->team.reset();
-    this->succ = nullptr;
-    this->pre = nullptr;
-    this->team = nullptr;
+    TeamSet::release(this->teamSet);
+    this->teamSet = nullptr;
 }
 
 int Player::getId() const {
@@ -26,15 +25,15 @@ int Player::getId() const {
 }
 
 int Player::getTeamId() const {
-    return this->teamId;
+    return this->getTeam()->getID();
 }
 
-shared_ptr<Team> Player::getTeam() const {
-    return this->team;
+Team* Player::getTeam() const {
+    return this->teamSet->getTeam();
 }
 
 int Player::getGamesPlayed() const {
-    return this->gamesPlayed + this->team->getGamesPlayed();
+    return this->gamesPlayed + this->teamSet->getGamesPlayed();
 }
 
 int Player::gamesWithoutTeam() const {
@@ -58,28 +57,29 @@ bool Player::isGoalKeeper() const {
     return this->goalKeeper;
 }
 
-shared_ptr<Player> Player::getPre() const{
-    return this->pre;
+TreeNode<Player, int>* Player::getIdNode() {
+    return &this->idNode;
 }
 
-shared_ptr<Player> Player::getSucc() const{
-    return this->succ;
+TreeNode<Player, Stats>* Player::getStatsNode() {
+    return &this->statsNode;
 }
 
-void Player::setId(const int id) {
-    this->id = id;
+TreeNode<Player, int>* Player::getTeamIdNode() {
+    return &this->teamIdNode;
 }
 
-void Player::setTeamId(const int teamId) {
-    this->teamId = teamId;
+TreeNode<Player, Stats>* Player::getTeamStatsNode() {
+    return &this->teamStatsNode;
 }
 
-void Player::setTeam(shared_ptr<Team> myTeam) {
-    this->team = myTeam;
-}
-
-void Player::addGamesPlayed(const int gamesPlayed) {
-    this->gamesPlayed += gamesPlayed;
+//the keys of the nodes change too, so the player must be out of every tree while updating
+void Player::setId(const int id) {
+    this->id = id;
+    this->idNode.key = id;
+    this->teamIdNode.key = id;
+    this->statsNode.key = this->getStats();
+    this->teamStatsNode.key = this->getStats();
 }
 
 void Player::addGoals(const int goals) {
@@ -94,21 +94,11 @@ void Player::setGoalKeeper(const bool isGoalKeeper) {
     this->goalKeeper = isGoalKeeper;
 }
 
-void Player::setPre(shared_ptr<Player> player) {
-    this->pre = player;
-}
-
-void Player::setSucc(shared_ptr<Player> player) {
-    this->succ = player;
-}
-
+//the keys of the stats nodes change too, so the player must be out of the stats trees while updating
 void Player::updateStats(int gamesPlayed, int scoredGoals, int cardsReceived) {
     this->gamesPlayed += gamesPlayed;
     this->goals += scoredGoals;
     this->cards += cardsReceived;
-}
-
-void Player::destruct(){
-    this->setPre(nullptr);
-    this->setSucc(nullptr);
+    this->statsNode.key = this->getStats();
+    this->teamStatsNode.key = this->getStats();
 }
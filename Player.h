@@ -3,55 +3,53 @@
 
 #include "Stats.h"
 #include "Team.h"
-#include <memory>
-
-using std::shared_ptr;
+#include "TeamSet.h"
+#include "TreeNode.h"
 
 class Team;
 
 class Player {
     private:
         int id;
-        int teamId;
-        shared_ptr<Team> team;
-        int gamesPlayed;
+        TeamSet* teamSet; //the set of the team the player joined; its root leads to the current team
+        int gamesPlayed; //games played before joining the team
         int goals;
         int cards;
         bool goalKeeper;
-        shared_ptr<Player> pre;
-        shared_ptr<Player> succ;
-        
+        //the player's nodes in the league's and the team's trees. they live in the player itself, so
+        //one allocation serves all four trees and taking the player out of a tree needs no search
+        TreeNode<Player, int> idNode;
+        TreeNode<Player, Stats> statsNode;
+        TreeNode<Player, int> teamIdNode;
+        TreeNode<Player, Stats> teamStatsNode;
+
 
     public:
-        Player() = default;
+        Player() = delete;
         ~Player();
-        Player(int id, int teamId, shared_ptr<Team> team, int gamesPlayed, int goals, int cards, bool goalKeeper);
-        Player(const Player& other) = default;
-        Player& operator=(const Player& other) = default;
+        Player(int id, TeamSet* teamSet, int gamesPlayed, int goals, int cards, bool goalKeeper);
+        Player(const Player& other) = delete;
+        Player& operator=(const Player& other) = delete;
 
         int getId() const;
         int getTeamId() const;
-        shared_ptr<Team> getTeam() const;
+        Team* getTeam() const;
         int getGamesPlayed() const;
         int gamesWithoutTeam() const;
         int getGoals() const;
         int getCards() const;
         Stats getStats() const;
         bool isGoalKeeper() const;
-        shared_ptr<Player> getPre() const;
-        shared_ptr<Player> getSucc() const;
+        TreeNode<Player, int>* getIdNode();
+        TreeNode<Player, Stats>* getStatsNode();
+        TreeNode<Player, int>* getTeamIdNode();
+        TreeNode<Player, Stats>* getTeamStatsNode();
 
         void setId(const int id);
-        void setTeamId(const int teamId);
-        void setTeam(shared_ptr<Team> myTeam);
-        void addGamesPlayed(const int gamesPlayed);
         void addGoals(const int goals);
         void addCards(const int cards);
         void setGoalKeeper(const bool isGoalKeeper);
-        void setPre(shared_ptr<Player> player);
-        void setSucc(shared_ptr<Player> player);
         void updateStats(int gamesPlayed, int scoredGoals, int cardsReceived);
-        void destruct();
 };
 
 #endif
\ No newline at end of file
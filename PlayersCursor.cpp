@@ -0,0 +1,17 @@
+#include "PlayersCursor.h"
+
+//a cursor at the first player
+PlayersCursor::PlayersCursor():
+    key(),
+    hasKey(false),
+    inclusive(false),
+    done(false)
+{}
+
+//a cursor at the first player whose stats are not below from
+PlayersCursor::PlayersCursor(const Stats& from):
+    key(from),
+    hasKey(true),
+    inclusive(true),
+    done(false)
+{}
@@ -0,0 +1,20 @@
+#ifndef PlayersCursor_h
+#define PlayersCursor_h
+
+#include "Stats.h"
+
+// Where a paged listing of players, in the order of get_all_players, stands. The position is a Stats key rather
+// than a node, so players may be added, removed or updated between pages: the next page simply resumes after
+// the last player returned.
+class PlayersCursor {
+    public:
+        Stats key;
+        bool hasKey; //false until the first page, for a cursor that starts from the first player
+        bool inclusive; //the next page starts at key itself rather than after it
+        bool done; //the last page was returned
+
+        PlayersCursor();
+        explicit PlayersCursor(const Stats& from);
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef Result_h
+#define Result_h
+
+#include "Command.h"
+#include "wet1util.h"
+
+// What running a Command returned. answer is set for a successful command that returns output_t<int>.
+// A successful get_all_players also hands over its ids in players, which the receiver must delete[].
+struct Result {
+    CommandType type;
+    StatusType status;
+    int answer;
+    int* players;
+    int playerCount;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef SpscRing_h
+#define SpscRing_h
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+// A bounded lock-free queue between exactly one producer thread and one consumer thread. Each side owns one
+// index and only reads the other's, with acquire/release ordering, so a push or a pop is a copy and one atomic
+// store. Each side also caches the other's index and rereads it only when the ring looks full or empty.
+// The indices sit on separate cache lines so the two threads do not contend for one line.
+template<class T>
+class SpscRing {
+        static const int CACHE_LINE = 64;
+        static const int SPINS = 64; //busy checks before a waiting side yields its core
+
+        T* items;
+        size_t mask; //capacity - 1, for a power of two capacity
+
+        char padHead[CACHE_LINE];
+        std::atomic<size_t> head; //the next item to pop, written by the consumer
+        size_t cachedTail; //the consumer's last look at tail
+
+        char padTail[CACHE_LINE];
+        std::atomic<size_t> tail; //the next free slot, written by the producer
+        size_t cachedHead; //the producer's last look at head
+        char padEnd[CACHE_LINE];
+
+    public:
+        explicit SpscRing(int capacityLog2);
+        ~SpscRing();
+        SpscRing(const SpscRing& other) = delete;
+        SpscRing& operator=(const SpscRing& other) = delete;
+
+        bool tryPush(const T& item);
+        bool tryPop(T& item);
+        void push(const T& item);
+        void pop(T& item);
+};
+
+//a ring of 2^capacityLog2 items
+template<class T>
+SpscRing<T>::SpscRing(int capacityLog2):
+    items(new T[size_t(1) << capacityLog2]),
+    mask((size_t(1) << capacityLog2) - 1),
+    head(0),
+    cachedTail(0),
+    tail(0),
+    cachedHead(0)
+{}
+
+template<class T>
+SpscRing<T>::~SpscRing() {
+    delete[] this->items;
+}
+
+//producer side. returns false if the ring is full
+template<class T>
+bool SpscRing<T>::tryPush(const T& item) {
+    size_t tail = this->tail.load(std::memory_order_relaxed);
+    if (tail - this->cachedHead > this->mask) {
+        this->cachedHead = this->head.load(std::memory_order_acquire);
+        if (tail - this->cachedHead > this->mask) {
+            return false;
+        }
+    }
+    this->items[tail & this->mask] = item;
+    this->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+//consumer side. returns false if the ring is empty
+template<class T>
+bool SpscRing<T>::tryPop(T& item) {
+    size_t head = this->head.load(std::memory_order_relaxed);
+    if (head == this->cachedTail) {
+        this->cachedTail = this->tail.load(std::memory_order_acquire);
+        if (head == this->cachedTail) {
+            return false;
+        }
+    }
+    item = this->items[head & this->mask];
+    this->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+//push, waiting for room
+template<class T>
+void SpscRing<T>::push(const T& item) {
+    for (int spins = 0; !this->tryPush(item); spins++) {
+        if (spins >= SPINS) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+//pop, waiting for an item
+template<class T>
+void SpscRing<T>::pop(T& item) {
+    for (int spins = 0; !this->tryPop(item); spins++) {
+        if (spins >= SPINS) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+#endif
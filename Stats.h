@@ -1,3 +1,6 @@
+#ifndef Stats_h
+#define Stats_h
+
 
 // A Class for comparing players by the rules of get_closest_player.
 class Stats {
@@ -45,4 +48,6 @@ friend bool operator!=(const Stats& l, const Stats& r) {
     return !(l == r);
 }
 
-};
\ No newline at end of file
+};
+
+#endif
@@ -1,21 +1,33 @@
 #include "Team.h"
 
-Team::Team(int id, int points):
+//the player trees are intrusive - the players hold their own nodes, and the world owns the players.
+//set is the team's own set, or nullptr if the team takes one over later with setSet
+Team::Team(int id, int points, TeamSet* set):
     id(id),
-    gamesPlayed(0),
+    set(nullptr),
     points(points),
     playersNum(0),
     goalKeepers(0),
     totalCards(0),
     totalGoals(0),
     topScorer(nullptr),
-    nextKosher(nullptr)
+    nextKosher(nullptr),
+    scoreNode(this, MatchScore(points, id))
 {
-    playersById = new AVLTree<Player, int>();
-    playersByStats = new AVLTree<Player, Stats>();
+    if (set != nullptr) {
+        this->setSet(set);
+    }
+    playersById = new AVLTree<Player, int>(nullptr);
+    playersByStats = new AVLTree<Player, Stats>(nullptr);
 }
 
 Team::~Team() {
+    if (this->set != nullptr) {
+        if (this->set->getTeam() == this) { //a united team's set now leads to the new team
+            this->set->setTeam(nullptr);
+        }
+        TeamSet::release(this->set);
+    }
     this->setNextKosher(nullptr);
     delete (this->playersById);
     delete (this->playersByStats);
@@ -26,7 +38,7 @@ int Team::getID() const{
 }
 
 int Team::getGamesPlayed() const{
-    return this->gamesPlayed;
+    return this->set->getGamesPlayed();
 }
 
 int Team::getPoints() const{
@@ -41,6 +53,11 @@ int Team::getTotalGoals() const {
     return this->totalGoals;
 }
 
+//the score the team plays a knockout with
+int Team::getMatchScore() const {
+    return this->points + this->totalGoals - this->totalCards;
+}
+
 int Team::getTotalCards() const {
     return this->totalCards;
 }
@@ -70,31 +87,51 @@ void Team::addPoints(int points) {
 }
 
 void Team::addGamesPlayed(int games) {
-    this->gamesPlayed += games;
+    this->set->addGamesPlayed(games);
 }
 
 void Team::setPlayersNum(int players) {
     this->playersNum = players;
 }
 
-shared_ptr<Player> Team::getTopScorer() const{
+TeamSet* Team::getSet() const{
+    return this->set;
+}
+
+//take over a set, after it was united with other teams' sets
+void Team::setSet(TeamSet* set){
+    set->acquire();
+    if (this->set != nullptr) {
+        this->set->setTeam(nullptr);
+        TeamSet::release(this->set);
+    }
+    this->set = set;
+    this->set->setTeam(this);
+}
+
+Player* Team::getTopScorer() const{
     return this->topScorer;
 }
 
-void Team::setTopScorer(shared_ptr<Player> player) {
+void Team::setTopScorer(Player* player) {
     this->topScorer = player;
 }
 
-shared_ptr<Team> Team::getNextKosher() const{
+Team* Team::getNextKosher() const{
     return this->nextKosher;
 }
 
-void Team::setNextKosher(shared_ptr<Team> team){
+void Team::setNextKosher(Team* team){
     this->nextKosher = team;
 }
 
 bool Team::isKosher() const {
-    return (this->getPlayersNum() >= 11 && this->getGoalKeepers() >= 1);
+    return this->isKosherWith(0, 0);
+}
+
+//whether the team would be kosher with morePlayers more players, moreGoalKeepers of them goalkeepers
+bool Team::isKosherWith(int morePlayers, int moreGoalKeepers) const {
+    return (this->getPlayersNum() + morePlayers >= 11 && this->getGoalKeepers() + moreGoalKeepers >= 1);
 }
 
 AVLTree<Player, int>* Team::getPlayersById() const{
@@ -105,9 +142,39 @@ AVLTree<Player, Stats>* Team::getPlayersByStats() const{
     return this->playersByStats;
 }
 
+TreeNode<Team, MatchScore>* Team::getScoreNode() {
+    return &this->scoreNode;
+}
+
+//set the key of the score node to the current match score. the node must not be linked into a tree
+void Team::updateScoreKey() {
+    this->scoreNode.key = MatchScore(this->getMatchScore(), this->id);
+}
+
 /*
 void Team::destruct(){
     this->setNextKosher(nullptr);
     delete (this->playersById);
     delete (this->playersByStats);
-} */
\ No newline at end of file
+} */
+
+//the best of the top scorers of the teams. Player is incomplete where TeamAggregate is declared
+typedef MaxAggregate<Player, Stats, &Player::getStats> TopScorer;
+
+TeamAggregate::Value TeamAggregate::identity() {
+    Value value = {Goals::identity(), Cards::identity(), Points::identity(), Best::identity(), TopScorer::identity()};
+    return value;
+}
+
+TeamAggregate::Value TeamAggregate::of(const Team* team, const int& id) {
+    Value value = {Goals::of(team, id), Cards::of(team, id), Points::of(team, id), Best::of(team, id),
+        team->getTopScorer()};
+    return value;
+}
+
+TeamAggregate::Value TeamAggregate::combine(const Value& left, const Value& right) {
+    Value value = {Goals::combine(left.goals, right.goals), Cards::combine(left.cards, right.cards),
+        Points::combine(left.points, right.points), Best::combine(left.best, right.best),
+        TopScorer::combine(left.topScorer, right.topScorer)};
+    return value;
+}
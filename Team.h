@@ -3,9 +3,8 @@
 
 #include "Player.h"
 #include "AVLTree.h"
-#include <memory>
-
-using std::shared_ptr;
+#include "TeamSet.h"
+#include "MatchScore.h"
 
 class Player;
 class Player;
@@ -13,22 +12,25 @@ class Player;
 class Team {
     private:
         int id;
-        int gamesPlayed;
+        TeamSet* set; //root of the team's union-find set, which also counts the team's games
         int points;
         int playersNum;
         int goalKeepers;
         int totalCards;
         int totalGoals;
-        shared_ptr<Player> topScorer;
-        shared_ptr<Team> nextKosher;
-        AVLTree<Player, int>* playersById;
-        AVLTree<Player, Stats>* playersByStats;
+        Player* topScorer;
+        Team* nextKosher;
+        TreeNode<Team, MatchScore> scoreNode; //links the team into the league table
+        AVLTree<Player, int>* playersById; //links the players' team id nodes
+        AVLTree<Player, Stats>* playersByStats; //links the players' team stats nodes
 
 
     public:
         Team() = delete;
-        Team(int id, int points);
+        Team(int id, int points, TeamSet* set);
         ~Team();
+        Team(const Team& other) = delete;
+        Team& operator=(const Team& other) = delete;
 
         int getID() const;
         int getGamesPlayed() const;
@@ -36,6 +38,7 @@ class Team {
         int getPlayersNum() const;
         int getTotalCards() const;
         int getTotalGoals() const;
+        int getMatchScore() const;
         int getGoalKeepers() const;
         void addGoalKeepers(int goalKeepers);
         void addPlayersNum(int players);
@@ -44,14 +47,39 @@ class Team {
         void addPoints(int points);
         void addGamesPlayed(int games);
         void setPlayersNum(int players);
-        shared_ptr<Player> getTopScorer() const;
-        void setTopScorer(shared_ptr<Player> player);
-        shared_ptr<Team> getNextKosher() const;
-        void setNextKosher(shared_ptr<Team> team);
+        TeamSet* getSet() const;
+        void setSet(TeamSet* set);
+        Player* getTopScorer() const;
+        void setTopScorer(Player* player);
+        Team* getNextKosher() const;
+        void setNextKosher(Team* team);
         bool isKosher() const;
+        bool isKosherWith(int morePlayers, int moreGoalKeepers) const;
         AVLTree<Player, int>* getPlayersById() const;
         AVLTree<Player, Stats>* getPlayersByStats() const;
+        TreeNode<Team, MatchScore>* getScoreNode();
+        void updateScoreKey();
         void destruct();
 };
 
+// What the league keeps over every subtree of its teams tree, for range queries over team ids
+struct TeamAggregate {
+    typedef SumAggregate<Team, int, &Team::getTotalGoals> Goals;
+    typedef SumAggregate<Team, int, &Team::getTotalCards> Cards;
+    typedef SumAggregate<Team, int, &Team::getPoints> Points;
+    typedef MaxAggregate<Team, int, &Team::getMatchScore> Best; //the highest id on a tie, like a knockout
+
+    struct Value {
+        int goals;
+        int cards;
+        int points;
+        const Team* best; //nullptr for no teams
+        const Player* topScorer; //nullptr for no players
+    };
+
+    static Value identity();
+    static Value of(const Team* team, const int& id);
+    static Value combine(const Value& left, const Value& right);
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "TeamSet.h"
+
+//a new set with no references. whoever keeps it must acquire it
+TeamSet::TeamSet(ObjectPool<TeamSet>* pool):
+    parent(nullptr),
+    rank(0),
+    games(0),
+    refs(0),
+    team(nullptr),
+    pool(pool)
+{}
+
+//find the root of the set, pointing every node on the way directly at it (path compression).
+//the games of each node are rebased so that the sum up to the root does not change. a node left with no
+//references once its children point at the root is freed - it is never this, which the caller holds
+TeamSet* TeamSet::findRoot() {
+    if (this->parent == nullptr) {
+        return this;
+    }
+    TeamSet* root = this->parent;
+    int total = this->games; //games of this node relative to the root
+    while (root->parent != nullptr) {
+        total += root->games;
+        root = root->parent;
+    }
+    TeamSet* node = this;
+    while (node != root) {
+        TeamSet* next = node->parent;
+        int ownGames = node->games;
+        if (node->refs == 0) {
+            next->refs--;
+            this->pool->destroy(node);
+        }
+        else if (next != root) {
+            node->games = total;
+            node->parent = root;
+            root->refs++;
+            next->refs--;
+        }
+        total -= ownGames;
+        node = next;
+    }
+    return root;
+}
+
+//the team the set belongs to now
+Team* TeamSet::getTeam() {
+    return this->findRoot()->team;
+}
+
+//the games the team played since a player of this set joined it
+int TeamSet::getGamesPlayed() {
+    TeamSet* root = this->findRoot();
+    if (this == root) {
+        return this->games;
+    }
+    return this->games + root->games;
+}
+
+//only called on a root
+void TeamSet::addGamesPlayed(int games) {
+    this->games += games;
+}
+
+void TeamSet::setTeam(Team* team) {
+    this->team = team;
+}
+
+void TeamSet::acquire() {
+    this->refs++;
+}
+
+//drop a reference to set. a set left with none is freed, and lets go of its parent in turn
+void TeamSet::release(TeamSet* set) {
+    while (set != nullptr) {
+        set->refs--;
+        if (set->refs > 0) {
+            return;
+        }
+        TeamSet* parent = set->parent;
+        set->pool->destroy(set);
+        set = parent;
+    }
+}
+
+//link the roots set1 and set2 by rank. returns the root of the united set
+TeamSet* TeamSet::unite(TeamSet* set1, TeamSet* set2) {
+    if (set1->rank < set2->rank) {
+        TeamSet* temp = set1;
+        set1 = set2;
+        set2 = temp;
+    }
+    set2->parent = set1;
+    set1->refs++;
+    set2->games -= set1->games;
+    if (set1->rank == set2->rank) {
+        set1->rank++;
+    }
+    return set1;
+}
@@ -0,0 +1,42 @@
+#ifndef TeamSet_h
+#define TeamSet_h
+
+#include "NodePool.h"
+
+class Team;
+
+// A node in a union-find forest over team records. Every team holds the root of a set, and every player
+// points at the set of the team it joined. When teams are united their sets are linked instead of moving
+// the players, so a player finds its current team through the root of its set.
+// The games played are kept relative to the parent: the games a player's team played since the player
+// joined are the sum of games along the path from the player's set to the root.
+// The sets live in a pool owned by the world. A set counts the teams, players and child sets pointing at
+// it, and goes back to the pool, letting go of its parent, once nothing does.
+class TeamSet {
+    private:
+        TeamSet* parent;
+        int rank;
+        int games;
+        int refs;
+        Team* team;
+        ObjectPool<TeamSet>* pool;
+
+        TeamSet* findRoot();
+
+    public:
+        TeamSet() = delete;
+        explicit TeamSet(ObjectPool<TeamSet>* pool);
+        ~TeamSet() = default;
+        TeamSet(const TeamSet& other) = delete;
+        TeamSet& operator=(const TeamSet& other) = delete;
+
+        Team* getTeam();
+        int getGamesPlayed();
+        void addGamesPlayed(int games);
+        void setTeam(Team* team);
+        void acquire();
+        static void release(TeamSet* set);
+        static TeamSet* unite(TeamSet* set1, TeamSet* set2);
+};
+
+#endif
@@ -1,67 +1,78 @@
 #ifndef TreeNodeID_h
 #define TreeNodeID_h
 
+#include "Aggregate.h"
 #include <memory>
 using namespace std;
 
-template <class T, class S>
-class TreeNode {
+template <class T, class S, class A = NoAggregate>
+class TreeNode : public AggregateSlot<A> {
 public:
-    shared_ptr<T> data;
+    T* data; //not owned - the record belongs to whoever created it
     S key;
     TreeNode* left;
     TreeNode* right;
+    TreeNode* parent;
     int height;
+    int size; //number of nodes in the subtree rooted here
 
     TreeNode();
-    TreeNode(shared_ptr<T> data, const S& key);
+    TreeNode(T* data, const S& key);
     TreeNode(const TreeNode& other);
     ~TreeNode() = default;
     TreeNode& operator=(const TreeNode& other);
 
 };
 
-template <class T, class S>
-TreeNode<T, S>::TreeNode():
+template <class T, class S, class A>
+TreeNode<T, S, A>::TreeNode():
     data(nullptr),
     key(),
     left(nullptr),
     right(nullptr),
-    height(1)
+    parent(nullptr),
+    height(1),
+    size(1)
 {}
 
 /*
-template <class T, class S>
-TreeNode<T, S>::~TreeNode() {
+template <class T, class S, class A>
+TreeNode<T, S, A>::~TreeNode() {
     this->data.reset();
 }
 */
 
-template <class T, class S>
-TreeNode<T, S>::TreeNode(shared_ptr<T> data, const S& key):
+template <class T, class S, class A>
+TreeNode<T, S, A>::TreeNode(T* data, const S& key):
     data(data),
     key(key),
     left(nullptr),
     right(nullptr),
-    height(1)
+    parent(nullptr),
+    height(1),
+    size(1)
 {}
 
-template<class T, class S>
-TreeNode<T, S>::TreeNode(const TreeNode<T, S>& other):
-    data(shared_ptr<T>(other.data)),
+template<class T, class S, class A>
+TreeNode<T, S, A>::TreeNode(const TreeNode<T, S, A>& other):
+    data(other.data),
     key(other.key),
     left(nullptr),
     right(nullptr),
-    height(1)
+    parent(nullptr),
+    height(1),
+    size(1)
 {}
 
-template <class T, class S>
-TreeNode<T, S>& TreeNode<T, S>::operator=(const TreeNode<T, S>& other) {
-    this->data = shared_ptr<T>(other.data);
+template <class T, class S, class A>
+TreeNode<T, S, A>& TreeNode<T, S, A>::operator=(const TreeNode<T, S, A>& other) {
+    this->data = other.data;
     this->key = other->key;
     this->left = nullptr;
     this->right = nullptr;
+    this->parent = nullptr;
     this->height = other->height;
+    this->size = 1;
     return *this;
 }
 
@@ -0,0 +1,57 @@
+// A faster drop-in for the main23a1 driver. It reads the same commands and prints the same output, but maps
+// its input and decodes it with CommandReader instead of parsing it through cin and string compares, and
+// formats its output into an OutputSink instead of flushing cout on every line.
+// One difference: a command with malformed arguments stops the run before it executes, where main23a1 still
+// runs it with whatever cin left in its variables.
+//
+// usage: WorldCupDriver [commands file]     reads standard input if no file is given
+
+#include "../worldcup23a1.h"
+#include "../CommandReader.h"
+#include "../CommandRunner.h"
+#include "../OutputSink.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+int main(int argc, char* argv[])
+{
+	int fd = 0;
+	if (argc > 1) {
+		fd = open(argv[1], O_RDONLY);
+		if (fd < 0) {
+			fprintf(stderr, "cannot open %s\n", argv[1]);
+			return 1;
+		}
+	}
+	CommandReader reader;
+	if (!reader.open(fd)) {
+		fprintf(stderr, "cannot read the commands\n");
+		return 1;
+	}
+	if (fd != 0) {
+		close(fd); //a mapping stays valid without its descriptor
+	}
+
+	OutputSink out(1);
+	world_cup_t* obj = new world_cup_t();
+	CommandRunner runner(obj, &out);
+	Command cmd;
+	int result = 0;
+	for (CommandReader::Status status = reader.next(cmd); status != CommandReader::Status::END; status = reader.next(cmd)) {
+		if (status == CommandReader::Status::UNKNOWN_COMMAND) {
+			runner.reportUnknownCommand(reader.getToken(), reader.getTokenLength());
+			result = -1;
+			break;
+		}
+		if (status == CommandReader::Status::INVALID_FORMAT) {
+			runner.reportInvalidFormat();
+			result = -1;
+			break;
+		}
+		runner.run(cmd);
+	}
+	out.flush();
+	delete obj;
+	return result;
+}
@@ -0,0 +1,80 @@
+// Converts a text command log, in the format of main23a1, into the binary format of CommandLog, which
+// WorldCupDriver replays straight from a mapping. A binary log is converted back into text, so
+// converting twice gives back the commands of the original log.
+//
+// usage: WorldCupLogConverter [input [output]]     standard input and output by default
+
+#include "../CommandLog.h"
+#include "../CommandReader.h"
+#include "../OutputSink.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+//the text line of command, as main23a1 reads it
+static void writeText(OutputSink& out, const Command& command)
+{
+	const char* name = Command::name(command.type);
+	out.write(name, strlen(name));
+	int args = Command::argCount(command.type);
+	for (int i = 0; i < args; i++) {
+		out.write(" ", 1);
+		out.writeInt(command.args[i]);
+	}
+	if (command.type == CommandType::ADD_PLAYER) {
+		if (command.goalKeeper) {
+			out.write(" true", 5);
+		}
+		else {
+			out.write(" false", 6);
+		}
+	}
+	out.write("\n", 1);
+}
+
+int main(int argc, char* argv[])
+{
+	int in = 0;
+	int out = 1;
+	if (argc > 1 && (in = open(argv[1], O_RDONLY)) < 0) {
+		fprintf(stderr, "cannot open %s\n", argv[1]);
+		return 1;
+	}
+	if (argc > 2 && (out = open(argv[2], O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) {
+		fprintf(stderr, "cannot create %s\n", argv[2]);
+		return 1;
+	}
+	CommandReader reader;
+	if (!reader.open(in)) {
+		fprintf(stderr, "cannot read the commands\n");
+		return 1;
+	}
+	bool toBinary = !reader.isBinary();
+	OutputSink sink(out);
+	if (toBinary) {
+		sink.write(reinterpret_cast<const char*>(CommandLog::MAGIC), CommandLog::MAGIC_SIZE);
+	}
+	Command command;
+	unsigned char record[CommandLog::MAX_RECORD];
+	long commands = 0;
+	for (CommandReader::Status status = reader.next(command); status != CommandReader::Status::END; status = reader.next(command)) {
+		if (status != CommandReader::Status::COMMAND) {
+			fprintf(stderr, "command %ld: %s\n", commands + 1,
+				(status == CommandReader::Status::UNKNOWN_COMMAND) ? "unknown command" : "invalid input format");
+			return 1;
+		}
+		if (toBinary) {
+			sink.write(reinterpret_cast<const char*>(record), CommandLog::encode(command, record));
+		}
+		else {
+			writeText(sink, command);
+		}
+		commands++;
+	}
+	if (!sink.flush()) {
+		fprintf(stderr, "cannot write the converted log\n");
+		return 1;
+	}
+	return 0;
+}
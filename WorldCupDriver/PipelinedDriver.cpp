@@ -0,0 +1,133 @@
+// WorldCupDriver split into three threads that overlap: a parser thread decodes commands with CommandReader,
+// this thread executes them on the world one at a time, and a formatter thread prints their results into an
+// OutputSink. The stages hand commands and results over through bounded SpscRings, so the output keeps the
+// order of the commands and is the same as WorldCupDriver's. If the threads cannot be started the stages
+// run one after another on this thread.
+//
+// usage: WorldCupPipelined [commands file]     reads standard input if no file is given
+
+#include "../worldcup23a1.h"
+#include "../CommandReader.h"
+#include "../CommandRunner.h"
+#include "../OutputSink.h"
+#include "../Result.h"
+#include "../SpscRing.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+
+static const int RING_CAPACITY_LOG2 = 12;
+
+// a decoded command, or the reason the parser stopped: the end of the input or a malformed command
+struct Parsed {
+	CommandReader::Status status;
+	Command command;
+};
+
+// a result, or the reason the run stopped, which the formatter reports last
+struct Formatted {
+	CommandReader::Status status;
+	Result result;
+};
+
+static void parse(CommandReader* reader, SpscRing<Parsed>* commands)
+{
+	Parsed parsed;
+	do {
+		parsed.status = reader->next(parsed.command);
+		commands->push(parsed);
+	} while (parsed.status == CommandReader::Status::COMMAND);
+}
+
+//how the run stopped, if it was not at the end of the input. the parser must have stopped for good, since the
+//token it left in the reader is read here
+static void report(CommandReader* reader, CommandRunner* runner, CommandReader::Status status)
+{
+	if (status == CommandReader::Status::UNKNOWN_COMMAND) {
+		runner->reportUnknownCommand(reader->getToken(), reader->getTokenLength());
+	}
+	else if (status == CommandReader::Status::INVALID_FORMAT) {
+		runner->reportInvalidFormat();
+	}
+}
+
+static void format(CommandReader* reader, CommandRunner* runner, SpscRing<Formatted>* results)
+{
+	Formatted formatted;
+	for (results->pop(formatted); formatted.status == CommandReader::Status::COMMAND; results->pop(formatted)) {
+		runner->format(formatted.result);
+	}
+	report(reader, runner, formatted.status);
+}
+
+int main(int argc, char* argv[])
+{
+	int fd = 0;
+	if (argc > 1) {
+		fd = open(argv[1], O_RDONLY);
+		if (fd < 0) {
+			fprintf(stderr, "cannot open %s\n", argv[1]);
+			return 1;
+		}
+	}
+	CommandReader reader;
+	if (!reader.open(fd)) {
+		fprintf(stderr, "cannot read the commands\n");
+		return 1;
+	}
+	if (fd != 0) {
+		close(fd); //a mapping stays valid without its descriptor
+	}
+
+	OutputSink out(1);
+	world_cup_t* obj = new world_cup_t();
+	CommandRunner runner(obj, &out);
+	SpscRing<Parsed> commands(RING_CAPACITY_LOG2);
+	SpscRing<Formatted> results(RING_CAPACITY_LOG2);
+	std::thread parser;
+	std::thread formatter;
+	try {
+		parser = std::thread(parse, &reader, &commands);
+		formatter = std::thread(format, &reader, &runner, &results);
+	}
+	catch (const std::system_error&) {
+		//whichever stage has no thread of its own runs on this one
+	}
+	Parsed parsed = Parsed();
+	Formatted formatted = Formatted();
+	while (true) {
+		if (parser.joinable()) {
+			commands.pop(parsed);
+		}
+		else {
+			parsed.status = reader.next(parsed.command);
+		}
+		if (parsed.status != CommandReader::Status::COMMAND) {
+			break;
+		}
+		if (formatter.joinable()) {
+			formatted.status = parsed.status;
+			runner.execute(parsed.command, formatted.result);
+			results.push(formatted);
+		}
+		else {
+			runner.run(parsed.command);
+		}
+	}
+	if (parser.joinable()) {
+		parser.join();
+	}
+	if (formatter.joinable()) {
+		formatted.status = parsed.status;
+		results.push(formatted);
+		formatter.join();
+	}
+	else {
+		report(&reader, &runner, parsed.status);
+	}
+	out.flush();
+	delete obj;
+	return (parsed.status == CommandReader::Status::END) ? 0 : -1;
+}
@@ -0,0 +1,177 @@
+// Soak test for world_cup_t: replays millions of add/remove/unite operations on a single world and checks
+// that its resident memory stays bounded by what the live teams and players need. Every cycle fills the
+// world, plays, updates and unites it down to one team, then empties it again, so after the first cycles
+// the memory in use should stay flat no matter how many cycles run.
+//
+// usage: WorldCupSoak [cycles]
+
+#include "../worldcup23a1.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <unistd.h>
+
+static const int TEAMS = 2048;
+static const int PLAYERS = 11 * TEAMS; //11 players and a goalkeeper for every team, so every team can play
+static const int MATCHES = 2000;
+static const int WARMUP_CYCLES = 3;
+
+//resident set size of this process in KB, from /proc/self/statm. -1 if it cannot be read
+static long residentKB() {
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if(statm == nullptr) {
+		return -1;
+	}
+	long pages = 0;
+	long resident = -1;
+	if(fscanf(statm, "%ld %ld", &pages, &resident) != 2) {
+		resident = -1;
+	}
+	fclose(statm);
+	return (resident < 0) ? -1 : resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+//play a match between the teams in slots a and b of teamIds, counting it in matches. two distinct teams must be
+//able to play, and a team cannot play itself
+static bool playMatch(world_cup_t& world, const int teamIds[], int a, int b, std::vector<int>& matches) {
+	if(a == b) {
+		return world.play_match(teamIds[a], teamIds[b]) == StatusType::INVALID_INPUT;
+	}
+	matches[a]++;
+	matches[b]++;
+	return world.play_match(teamIds[a], teamIds[b]) == StatusType::SUCCESS;
+}
+
+//add the matches every player's team played to the games the player should have played, and start counting again
+static void addMatches(std::vector<int>& expected, const std::vector<int>& slots, std::vector<int>& matches) {
+	for(int i = 0; i < PLAYERS; i++) {
+		expected[i] += matches[slots[i]];
+	}
+	for(int& count : matches) {
+		count = 0;
+	}
+}
+
+//fill the world, play, unite all of it into one team and empty it again, checking the games every player played
+//before it is removed. returns the number of operations run, or -1 if one of them did not return what it should
+static long runCycle(world_cup_t& world, int cycle, std::mt19937& random) {
+	long ops = 0;
+	int nextTeamId = cycle * TEAMS * 2 + 1;
+	int firstPlayerId = cycle * PLAYERS + 1;
+	int teamIds[TEAMS];
+	std::vector<int> expected(PLAYERS); //the games every player should have played
+	std::vector<int> slots(PLAYERS); //the index in teamIds of every player's team
+	std::vector<int> matches(TEAMS, 0); //the matches of every team since addMatches last ran
+	for(int i = 0; i < TEAMS; i++) {
+		teamIds[i] = nextTeamId++;
+		if(world.add_team(teamIds[i], random() % 50) != StatusType::SUCCESS) {
+			return -1;
+		}
+		ops++;
+	}
+	for(int i = 0; i < PLAYERS; i++) {
+		slots[i] = i % TEAMS;
+		expected[i] = 1 + random() % 5;
+		int goals = random() % 10;
+		int cards = random() % 4;
+		if(world.add_player(firstPlayerId + i, teamIds[slots[i]], expected[i], goals, cards, i < TEAMS) != StatusType::SUCCESS) {
+			return -1;
+		}
+		ops++;
+	}
+	for(int i = 0; i < MATCHES; i++) {
+		if(!playMatch(world, teamIds, random() % TEAMS, random() % TEAMS, matches)) {
+			return -1;
+		}
+		ops++;
+	}
+	for(int i = 0; i < PLAYERS; i++) {
+		int player = random() % PLAYERS;
+		expected[player]++;
+		if(world.update_player_stats(firstPlayerId + player, 1, random() % 3, random() % 2) != StatusType::SUCCESS) {
+			return -1;
+		}
+		ops++;
+	}
+	//unite neighbours until a single team is left, so the sets of the teams form deep trees. the teams that are
+	//left play between the rounds, so the games are kept relative to sets at every depth
+	for(int alive = TEAMS; alive > 1; alive = (alive + 1) / 2) {
+		addMatches(expected, slots, matches);
+		for(int i = 0; i + 1 < alive; i += 2) {
+			int newTeamId = nextTeamId++;
+			if(world.unite_teams(teamIds[i], teamIds[i + 1], newTeamId) != StatusType::SUCCESS) {
+				return -1;
+			}
+			teamIds[i / 2] = newTeamId;
+			ops++;
+		}
+		if(alive % 2 == 1) {
+			teamIds[alive / 2] = teamIds[alive - 1];
+		}
+		for(int i = 0; i < PLAYERS; i++) {
+			slots[i] /= 2;
+		}
+		int left = (alive + 1) / 2;
+		for(int i = 0; i + 1 < left; i += 2) {
+			if(!playMatch(world, teamIds, i, i + 1, matches)) {
+				return -1;
+			}
+			ops++;
+		}
+	}
+	addMatches(expected, slots, matches);
+	for(int i = 0; i < PLAYERS; i++) {
+		output_t<int> games = world.get_num_played_games(firstPlayerId + i);
+		if(games.status() != StatusType::SUCCESS || games.ans() != expected[i] ||
+		world.remove_player(firstPlayerId + i) != StatusType::SUCCESS) {
+			return -1;
+		}
+		ops += 2;
+	}
+	if(world.remove_team(teamIds[0]) != StatusType::SUCCESS) {
+		return -1;
+	}
+	return ops + 1;
+}
+
+int main(int argc, char* argv[]) {
+	int cycles = (argc > 1) ? atoi(argv[1]) : 40;
+	if(cycles <= WARMUP_CYCLES) {
+		cycles = WARMUP_CYCLES + 1;
+	}
+	std::mt19937 random(2023);
+	world_cup_t world;
+	long ops = 0;
+	long baseline = -1;
+	long peak = -1;
+	for(int cycle = 0; cycle < cycles; cycle++) {
+		long cycleOps = runCycle(world, cycle, random);
+		if(cycleOps < 0) {
+			printf("cycle %d: an operation failed\n", cycle);
+			return 1;
+		}
+		ops += cycleOps;
+		long rss = residentKB();
+		if(cycle + 1 == WARMUP_CYCLES) {
+			baseline = rss;
+		}
+		if(rss > peak) {
+			peak = rss;
+		}
+		printf("cycle %d: %ld ops, rss %ld KB\n", cycle, ops, rss);
+	}
+	if(baseline < 0) {
+		printf("could not read the resident set size\n");
+		return 1;
+	}
+	//allow some slack for the allocator's own bookkeeping
+	long limit = baseline + baseline / 50 + 256;
+	printf("%ld ops, rss after warmup %ld KB, peak %ld KB, limit %ld KB\n", ops, baseline, peak, limit);
+	if(peak > limit) {
+		printf("FAILED: resident memory kept growing\n");
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
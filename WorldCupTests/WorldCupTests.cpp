@@ -7,6 +7,18 @@
 #include "catch.hpp"
 #include <stdlib.h>
 #include "../worldcup23a1.h"
+#include "../CommandReader.h"
+#include "../OutputSink.h"
+#include "../CommandLog.h"
+#include "../CommandRunner.h"
+#include <fcntl.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -2818,4 +2830,1609 @@ TEST_CASE("knockout")
 
         delete obj;
     }
+
+    SECTION("repeated knockouts follow every change")
+    {
+        world_cup_t *obj = new world_cup_t();
+        for (int teamId = 1; teamId <= 3; teamId++)
+        {
+            REQUIRE(obj->add_team(teamId, 0) == StatusType::SUCCESS);
+            for (int i = 1; i <= 11; i++)
+            {
+                REQUIRE(obj->add_player(teamId * 100 + i, teamId, 1, 0, 0, i == 1) == StatusType::SUCCESS);
+            }
+        }
+        // Strengths team1:0 team2:0 team3:0
+        REQUIRE(obj->knockout_winner(1, 3).ans() == 2);
+        REQUIRE(obj->knockout_winner(1, 3).ans() == 2);
+
+        REQUIRE(obj->update_player_stats(301, 1, 4, 0) == StatusType::SUCCESS);
+        // Strengths team1:0 team2:0 team3:4
+        REQUIRE(obj->knockout_winner(1, 3).ans() == 3);
+        REQUIRE(obj->update_player_stats(301, 1, 1, 1) == StatusType::SUCCESS);
+        REQUIRE(obj->knockout_winner(1, 3).ans() == 3);
+
+        REQUIRE(obj->play_match(1, 2) == StatusType::SUCCESS);
+        // Strengths team1:1 team2:1 team3:4
+        REQUIRE(obj->knockout_winner(1, 3).ans() == 2);
+
+        REQUIRE(obj->remove_player(211) == StatusType::SUCCESS);
+        // team2 is not kosher
+        REQUIRE(obj->knockout_winner(1, 3).ans() == 3);
+        REQUIRE(obj->add_player(211, 2, 1, 0, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->knockout_winner(1, 3).ans() == 2);
+
+        REQUIRE(obj->unite_teams(1, 2, 5) == StatusType::SUCCESS);
+        // Strengths team3:4 team5:2
+        REQUIRE(obj->knockout_winner(1, 3).ans() == 3);
+        REQUIRE(obj->knockout_winner(1, 5).ans() == 3);
+        REQUIRE(obj->update_player_stats(101, 1, 3, 0) == StatusType::SUCCESS);
+        // Strengths team3:4 team5:5
+        REQUIRE(obj->knockout_winner(1, 5).ans() == 5);
+        REQUIRE(obj->knockout_winner(1, 2).status() == StatusType::FAILURE);
+        delete obj;
+    }
+
+    SECTION("wide knockouts match a round by round simulation")
+    {
+        // sizes around the vector widths, and one wide enough to split its first rounds between threads
+        int sizes[] = {1, 2, 3, 7, 8, 9, 15, 16, 17, 33, 1000, 1 << 17 | 5};
+        srand(2023);
+        for (int size : sizes)
+        {
+            vector<int> ids(size);
+            vector<int> scores(size);
+            Knockout serial(1);
+            Knockout parallel(4);
+            bool added = true;
+            for (int i = 0; i < size; i++)
+            {
+                ids[i] = 2 * i + 1;
+                scores[i] = rand() % 7 - 3; // small scores, so there are many ties
+                added = serial.add(ids[i], scores[i]) && parallel.add(ids[i], scores[i]) && added;
+            }
+            REQUIRE(added);
+            while (ids.size() > 1)
+            {
+                vector<int> nextIds;
+                vector<int> nextScores;
+                for (size_t i = 0; i + 1 < ids.size(); i += 2)
+                {
+                    bool firstWins = scores[i] > scores[i + 1] || (scores[i] == scores[i + 1] && ids[i] > ids[i + 1]);
+                    nextIds.push_back(firstWins ? ids[i] : ids[i + 1]);
+                    nextScores.push_back(scores[i] + scores[i + 1] + 3);
+                }
+                if (ids.size() % 2 == 1)
+                {
+                    nextIds.push_back(ids.back());
+                    nextScores.push_back(scores.back());
+                }
+                ids = nextIds;
+                scores = nextScores;
+            }
+            REQUIRE(serial.play() == ids[0]);
+            REQUIRE(parallel.play() == ids[0]);
+        }
+    }
+
+    SECTION("scores that overflow wrap the same way in the vector and scalar paths")
+    {
+        // 2147483647 + 2147483647 + 3 wraps to 1, so every pair is won by a team whose sum wrapped to a small
+        // number. 19 teams put pairs in the vector loop and in the scalar tail of the first rounds
+        const int size = 19;
+        vector<int> ids(size);
+        vector<unsigned> scores(size);
+        Knockout knockout(1);
+        bool added = true;
+        for (int i = 0; i < size; i++)
+        {
+            ids[i] = i + 1;
+            scores[i] = (i % 3 == 0) ? 2147483647u : 2147483600u + i;
+            added = knockout.add(ids[i], static_cast<int>(scores[i])) && added;
+        }
+        REQUIRE(added);
+        while (ids.size() > 1)
+        {
+            vector<int> nextIds;
+            vector<unsigned> nextScores;
+            for (size_t i = 0; i + 1 < ids.size(); i += 2)
+            {
+                int first = static_cast<int>(scores[i]);
+                int second = static_cast<int>(scores[i + 1]);
+                bool firstWins = first > second || (first == second && ids[i] > ids[i + 1]);
+                nextIds.push_back(firstWins ? ids[i] : ids[i + 1]);
+                nextScores.push_back(scores[i] + scores[i + 1] + 3u);
+            }
+            if (ids.size() % 2 == 1)
+            {
+                nextIds.push_back(ids.back());
+                nextScores.push_back(scores.back());
+            }
+            ids = nextIds;
+            scores = nextScores;
+        }
+        REQUIRE(knockout.play() == ids[0]);
+    }
+}
+
+TEST_CASE("KnockoutCache")
+{
+    // the cache holds 16 ranges. range i is (i, i) and its winner is i
+    KnockoutCache cache;
+    int winner = 0;
+    for (int i = 0; i < 17; i++)
+    {
+        cache.store(i, i, i);
+    }
+    REQUIRE(!cache.find(0, 0, winner));
+    REQUIRE(cache.find(16, 16, winner));
+    REQUIRE(winner == 16);
+
+    SECTION("a freed entry is reused before anything is evicted")
+    {
+        cache.invalidate(5);
+        REQUIRE(!cache.find(5, 5, winner));
+        cache.store(17, 17, 17);
+        for (int i = 1; i <= 17; i++)
+        {
+            REQUIRE(cache.find(i, i, winner) == (i != 5));
+        }
+    }
+
+    SECTION("a full cache evicts the oldest entry, even after entries were freed out of order")
+    {
+        cache.invalidate(5);
+        cache.store(17, 17, 17); // takes the entry range 5 had
+        for (int i = 18; i < 22; i++)
+        {
+            cache.store(i, i, i); // evicts ranges 1 to 4
+        }
+        cache.store(22, 22, 22); // evicts range 6, not the newer range 17
+        for (int i = 1; i <= 6; i++)
+        {
+            REQUIRE(!cache.find(i, i, winner));
+        }
+        for (int i = 7; i <= 22; i++)
+        {
+            REQUIRE(cache.find(i, i, winner));
+            REQUIRE(winner == i);
+        }
+    }
+}
+
+TEST_CASE("get_scoring_rank and get_kth_top_scorer")
+{
+    SECTION("invalid input and failure")
+    {
+        world_cup_t *obj = new world_cup_t();
+        REQUIRE(obj->get_scoring_rank(0, 1).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_scoring_rank(1, 0).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_kth_top_scorer(0, 1).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_kth_top_scorer(1, 0).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_scoring_rank(1, -1).status() == StatusType::FAILURE);
+        REQUIRE(obj->get_kth_top_scorer(-1, 1).status() == StatusType::FAILURE);
+
+        REQUIRE(obj->add_team(1, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->add_team(2, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(10, 1, 1, 5, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->get_scoring_rank(10, 2).status() == StatusType::FAILURE);
+        REQUIRE(obj->get_scoring_rank(10, 3).status() == StatusType::FAILURE);
+        REQUIRE(obj->get_kth_top_scorer(1, 2).status() == StatusType::FAILURE);
+        REQUIRE(obj->get_kth_top_scorer(2, 1).status() == StatusType::FAILURE);
+        delete obj;
+    }
+
+    SECTION("ranks in the league and in a team")
+    {
+        world_cup_t *obj = new world_cup_t();
+        REQUIRE(obj->add_team(1, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->add_team(2, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(10, 1, 1, 5, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(11, 2, 1, 7, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(12, 1, 1, 7, 2, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(13, 2, 1, 1, 0, false) == StatusType::SUCCESS);
+        // league order: 11, 12, 10, 13
+
+        output_t<int> res = obj->get_scoring_rank(11, -1);
+        REQUIRE(res.status() == StatusType::SUCCESS);
+        REQUIRE(res.ans() == 1);
+        REQUIRE(obj->get_scoring_rank(12, -1).ans() == 2);
+        REQUIRE(obj->get_scoring_rank(13, -1).ans() == 4);
+        REQUIRE(obj->get_scoring_rank(10, 1).ans() == 2);
+        REQUIRE(obj->get_scoring_rank(13, 2).ans() == 2);
+
+        REQUIRE(obj->get_kth_top_scorer(-1, 1).ans() == 11);
+        REQUIRE(obj->get_kth_top_scorer(-1, 3).ans() == 10);
+        REQUIRE(obj->get_kth_top_scorer(1, 1).ans() == 12);
+        REQUIRE(obj->get_kth_top_scorer(2, 2).ans() == 13);
+
+        REQUIRE(obj->update_player_stats(13, 1, 10, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->get_scoring_rank(13, -1).ans() == 1);
+        REQUIRE(obj->get_kth_top_scorer(-1, 4).ans() == 10);
+
+        REQUIRE(obj->remove_player(11) == StatusType::SUCCESS);
+        REQUIRE(obj->get_kth_top_scorer(2, 1).ans() == 13);
+        REQUIRE(obj->get_kth_top_scorer(2, 2).status() == StatusType::FAILURE);
+
+        REQUIRE(obj->unite_teams(1, 2, 3) == StatusType::SUCCESS);
+        REQUIRE(obj->get_scoring_rank(10, 3).ans() == 3);
+        REQUIRE(obj->get_kth_top_scorer(3, 2).ans() == 12);
+        delete obj;
+    }
+}
+
+TEST_CASE("get_kosher_count")
+{
+    SECTION("invalid input")
+    {
+        world_cup_t *obj = new world_cup_t();
+        REQUIRE(obj->get_kosher_count(-1, 5).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_kosher_count(1, -5).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_kosher_count(5, 1).status() == StatusType::INVALID_INPUT);
+        output_t<int> res = obj->get_kosher_count(0, 100);
+        REQUIRE(res.status() == StatusType::SUCCESS);
+        REQUIRE(res.ans() == 0);
+        delete obj;
+    }
+
+    SECTION("counts follow the kosher teams")
+    {
+        world_cup_t *obj = new world_cup_t();
+        for (int teamId = 2; teamId <= 10; teamId += 2)
+        {
+            REQUIRE(obj->add_team(teamId, 0) == StatusType::SUCCESS);
+            for (int i = 1; i <= 11; i++)
+            {
+                REQUIRE(obj->add_player(teamId * 100 + i, teamId, 1, 0, 0, i == 1) == StatusType::SUCCESS);
+            }
+        }
+        REQUIRE(obj->add_team(1, 0) == StatusType::SUCCESS);
+        // kosher teams: 2, 4, 6, 8, 10
+        REQUIRE(obj->get_kosher_count(0, 100).ans() == 5);
+        REQUIRE(obj->get_kosher_count(1, 1).ans() == 0);
+        REQUIRE(obj->get_kosher_count(3, 8).ans() == 3);
+        REQUIRE(obj->get_kosher_count(4, 4).ans() == 1);
+
+        REQUIRE(obj->remove_player(601) == StatusType::SUCCESS);
+        // team 6 has no goalkeeper
+        REQUIRE(obj->get_kosher_count(3, 8).ans() == 2);
+        REQUIRE(obj->knockout_winner(5, 7).status() == StatusType::FAILURE);
+
+        REQUIRE(obj->unite_teams(2, 4, 3) == StatusType::SUCCESS);
+        REQUIRE(obj->get_kosher_count(0, 5).ans() == 1);
+        REQUIRE(obj->get_kosher_count(0, 100).ans() == 3);
+        REQUIRE(obj->knockout_winner(0, 100).ans() == 8);
+        delete obj;
+    }
+}
+
+TEST_CASE("range aggregates")
+{
+    SECTION("invalid input")
+    {
+        world_cup_t *obj = new world_cup_t();
+        REQUIRE(obj->get_goals_in_range(-1, 5).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_cards_in_range(1, -5).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_points_in_range(5, 1).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_best_team_in_range(5, 1).status() == StatusType::INVALID_INPUT);
+        output_t<int> res = obj->get_goals_in_range(0, 100);
+        REQUIRE(res.status() == StatusType::SUCCESS);
+        REQUIRE(res.ans() == 0);
+        REQUIRE(obj->get_best_team_in_range(0, 100).status() == StatusType::FAILURE);
+        delete obj;
+    }
+
+    SECTION("aggregates follow every change")
+    {
+        world_cup_t *obj = new world_cup_t();
+        for (int teamId = 1; teamId <= 4; teamId++)
+        {
+            REQUIRE(obj->add_team(teamId, teamId) == StatusType::SUCCESS);
+            for (int i = 1; i <= 11; i++)
+            {
+                REQUIRE(obj->add_player(teamId * 100 + i, teamId, 1, teamId, 1, i == 1) == StatusType::SUCCESS);
+            }
+        }
+        // team t: t points, 11t goals, 11 cards, match score 12t - 11
+        REQUIRE(obj->get_goals_in_range(0, 100).ans() == 110);
+        REQUIRE(obj->get_cards_in_range(2, 3).ans() == 22);
+        REQUIRE(obj->get_points_in_range(2, 4).ans() == 9);
+        REQUIRE(obj->get_points_in_range(5, 100).ans() == 0);
+        REQUIRE(obj->get_best_team_in_range(0, 100).ans() == 4);
+        REQUIRE(obj->get_best_team_in_range(1, 2).ans() == 2);
+
+        REQUIRE(obj->update_player_stats(101, 1, 50, 0) == StatusType::SUCCESS);
+        // team 1: 61 goals, match score 51
+        REQUIRE(obj->get_goals_in_range(1, 1).ans() == 61);
+        REQUIRE(obj->get_best_team_in_range(0, 100).ans() == 1);
+
+        REQUIRE(obj->play_match(1, 4) == StatusType::SUCCESS);
+        REQUIRE(obj->get_points_in_range(0, 100).ans() == 13);
+
+        REQUIRE(obj->remove_player(101) == StatusType::SUCCESS);
+        REQUIRE(obj->get_goals_in_range(1, 1).ans() == 10);
+        REQUIRE(obj->get_cards_in_range(0, 100).ans() == 43);
+        REQUIRE(obj->get_best_team_in_range(0, 100).ans() == 4);
+
+        REQUIRE(obj->unite_teams(2, 3, 9) == StatusType::SUCCESS);
+        REQUIRE(obj->get_goals_in_range(2, 3).ans() == 0);
+        REQUIRE(obj->get_goals_in_range(9, 9).ans() == 55);
+        REQUIRE(obj->get_points_in_range(0, 100).ans() == 13);
+        // team 9: 5 points, 55 goals, 22 cards
+        REQUIRE(obj->get_best_team_in_range(0, 100).ans() == 9);
+        delete obj;
+    }
+
+    SECTION("range queries match a scan of the teams")
+    {
+        world_cup_t *obj = new world_cup_t();
+        const int teams = 300;
+        int goals[teams + 1];
+        int points[teams + 1];
+        bool added = true;
+        for (int teamId = 1; teamId <= teams; teamId++)
+        {
+            points[teamId] = (teamId * 7) % 13;
+            goals[teamId] = (teamId * 11) % 17;
+            added = added && obj->add_team(teamId, points[teamId]) == StatusType::SUCCESS;
+            added = added && obj->add_player(teamId, teamId, 1, goals[teamId], 0, false) == StatusType::SUCCESS;
+        }
+        for (int teamId = 3; teamId <= teams; teamId += 3)
+        {
+            added = added && obj->remove_player(teamId) == StatusType::SUCCESS;
+            added = added && obj->remove_team(teamId) == StatusType::SUCCESS;
+        }
+        REQUIRE(added);
+        bool matches = true;
+        for (int low = 0; low <= teams; low += 7)
+        {
+            for (int high = low; high <= teams; high += 13)
+            {
+                int goalSum = 0;
+                int pointSum = 0;
+                int best = 0;
+                for (int teamId = (low > 0) ? low : 1; teamId <= high; teamId++)
+                {
+                    if (teamId % 3 == 0)
+                    {
+                        continue;
+                    }
+                    goalSum += goals[teamId];
+                    pointSum += points[teamId];
+                    if (best == 0 || goals[teamId] + points[teamId] >= goals[best] + points[best])
+                    {
+                        best = teamId;
+                    }
+                }
+                matches = matches && obj->get_goals_in_range(low, high).ans() == goalSum;
+                matches = matches && obj->get_points_in_range(low, high).ans() == pointSum;
+                output_t<int> bestTeam = obj->get_best_team_in_range(low, high);
+                matches = matches && (best == 0 ? bestTeam.status() == StatusType::FAILURE : bestTeam.ans() == best);
+            }
+        }
+        REQUIRE(matches);
+        delete obj;
+    }
+}
+
+TEST_CASE("get_top_scorer_in_range")
+{
+    SECTION("invalid input")
+    {
+        world_cup_t *obj = new world_cup_t();
+        REQUIRE(obj->get_top_scorer_in_range(-1, 5).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_top_scorer_in_range(5, 1).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_top_scorer_in_range(0, 100).status() == StatusType::FAILURE);
+        REQUIRE(obj->add_team(1, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_scorer_in_range(0, 100).status() == StatusType::FAILURE);
+        delete obj;
+    }
+
+    SECTION("top scorer follows every change")
+    {
+        world_cup_t *obj = new world_cup_t();
+        for (int teamId = 1; teamId <= 5; teamId++)
+        {
+            REQUIRE(obj->add_team(teamId, 0) == StatusType::SUCCESS);
+        }
+        REQUIRE(obj->add_player(11, 1, 1, 5, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(21, 2, 1, 7, 2, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(22, 2, 1, 7, 1, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(41, 4, 1, 3, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(51, 5, 1, 7, 1, false) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_scorer_in_range(0, 100).ans() == 51);
+        REQUIRE(obj->get_top_scorer_in_range(0, 4).ans() == 22);
+        REQUIRE(obj->get_top_scorer_in_range(3, 4).ans() == 41);
+        REQUIRE(obj->get_top_scorer_in_range(3, 3).status() == StatusType::FAILURE);
+
+        REQUIRE(obj->update_player_stats(41, 1, 10, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_scorer_in_range(0, 100).ans() == 41);
+        REQUIRE(obj->remove_player(41) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_scorer_in_range(3, 4).status() == StatusType::FAILURE);
+        REQUIRE(obj->get_top_scorer_in_range(0, 100).ans() == 51);
+
+        REQUIRE(obj->remove_player(22) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_scorer_in_range(2, 2).ans() == 21);
+
+        REQUIRE(obj->unite_teams(1, 3, 6) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_scorer(6).ans() == 11);
+        REQUIRE(obj->get_top_scorer_in_range(6, 100).ans() == 11);
+        REQUIRE(obj->unite_teams(2, 5, 3) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_scorer_in_range(3, 3).ans() == 51);
+        REQUIRE(obj->get_top_scorer(-1).ans() == 51);
+        delete obj;
+    }
+
+    SECTION("a top scorer who only gets cards drops below a teammate")
+    {
+        world_cup_t *obj = new world_cup_t();
+        REQUIRE(obj->add_team(1, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->add_team(2, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(11, 1, 1, 5, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(12, 1, 1, 5, 1, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(21, 2, 1, 4, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_scorer_in_range(1, 2).ans() == 11);
+
+        REQUIRE(obj->update_player_stats(11, 1, 0, 2) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_scorer_in_range(1, 2).ans() == 12);
+        REQUIRE(obj->get_top_scorer_in_range(1, 1).ans() == 12);
+        REQUIRE(obj->get_top_scorer(1).ans() == 12);
+        REQUIRE(obj->get_top_scorer(-1).ans() == 12);
+
+        REQUIRE(obj->update_player_stats(12, 1, 0, 5) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_scorer_in_range(0, 100).ans() == 11);
+        REQUIRE(obj->get_top_scorer(-1).ans() == 11);
+        delete obj;
+    }
+}
+
+TEST_CASE("league table")
+{
+    SECTION("invalid input")
+    {
+        world_cup_t *obj = new world_cup_t();
+        int output[4];
+        REQUIRE(obj->get_top_teams(0, output).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_top_teams(3, nullptr).status() == StatusType::INVALID_INPUT);
+        output_t<int> res = obj->get_top_teams(3, output);
+        REQUIRE(res.status() == StatusType::SUCCESS);
+        REQUIRE(res.ans() == 0);
+        REQUIRE(obj->get_teams_with_score_count(-100).ans() == 0);
+        REQUIRE(obj->get_teams_with_score(-100, nullptr) == StatusType::SUCCESS);
+        REQUIRE(obj->add_team(1, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->get_teams_with_score(0, nullptr) == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_teams_with_score(1, nullptr) == StatusType::SUCCESS);
+        delete obj;
+    }
+
+    SECTION("the table follows every change")
+    {
+        world_cup_t *obj = new world_cup_t();
+        int output[8];
+        for (int teamId = 1; teamId <= 4; teamId++)
+        {
+            REQUIRE(obj->add_team(teamId, 10 * teamId) == StatusType::SUCCESS);
+        }
+        // scores: 1:10 2:20 3:30 4:40
+        REQUIRE(obj->get_top_teams(2, output).ans() == 2);
+        REQUIRE(output[0] == 4);
+        REQUIRE(output[1] == 3);
+        REQUIRE(obj->get_top_teams(8, output).ans() == 4);
+        REQUIRE(output[3] == 1);
+
+        REQUIRE(obj->add_player(11, 1, 1, 35, 0, false) == StatusType::SUCCESS);
+        // scores: 1:45 2:20 3:30 4:40
+        REQUIRE(obj->get_top_teams(1, output).ans() == 1);
+        REQUIRE(output[0] == 1);
+        REQUIRE(obj->update_player_stats(11, 1, 0, 15) == StatusType::SUCCESS);
+        // scores: 1:30 2:20 3:30 4:40
+        REQUIRE(obj->get_top_teams(3, output).ans() == 3);
+        REQUIRE(output[0] == 4);
+        REQUIRE(output[1] == 3);
+        REQUIRE(output[2] == 1);
+        REQUIRE(obj->get_teams_with_score_count(30).ans() == 3);
+        REQUIRE(obj->get_teams_with_score_count(31).ans() == 1);
+        REQUIRE(obj->get_teams_with_score_count(41).ans() == 0);
+        REQUIRE(obj->get_teams_with_score(30, output) == StatusType::SUCCESS);
+        REQUIRE(output[0] == 4);
+        REQUIRE(output[1] == 3);
+        REQUIRE(output[2] == 1);
+
+        REQUIRE(obj->remove_player(11) == StatusType::SUCCESS);
+        // scores: 1:10 2:20 3:30 4:40
+        REQUIRE(obj->get_teams_with_score_count(20).ans() == 3);
+
+        for (int i = 1; i <= 11; i++)
+        {
+            REQUIRE(obj->add_player(100 + i, 1, 1, 0, 0, i == 1) == StatusType::SUCCESS);
+            REQUIRE(obj->add_player(200 + i, 2, 1, 0, 0, i == 1) == StatusType::SUCCESS);
+        }
+        REQUIRE(obj->play_match(1, 2) == StatusType::SUCCESS);
+        // scores: 1:10 2:23 3:30 4:40
+        REQUIRE(obj->get_teams_with_score_count(21).ans() == 3);
+
+        REQUIRE(obj->unite_teams(1, 2, 5) == StatusType::SUCCESS);
+        REQUIRE(obj->remove_team(4) == StatusType::SUCCESS);
+        // scores: 3:30 5:33
+        REQUIRE(obj->get_top_teams(8, output).ans() == 2);
+        REQUIRE(output[0] == 5);
+        REQUIRE(output[1] == 3);
+        REQUIRE(obj->get_teams_with_score_count(-100).ans() == 2);
+        delete obj;
+    }
+}
+
+TEST_CASE("get_top_k_scorers")
+{
+    SECTION("invalid input")
+    {
+        world_cup_t *obj = new world_cup_t();
+        int output[4];
+        REQUIRE(obj->get_top_k_scorers(0, 3, output).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_top_k_scorers(-1, 0, output).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_top_k_scorers(-1, 3, nullptr).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_top_k_scorers(1, 3, output).status() == StatusType::FAILURE);
+        output_t<int> res = obj->get_top_k_scorers(-1, 3, output);
+        REQUIRE(res.status() == StatusType::SUCCESS);
+        REQUIRE(res.ans() == 0);
+        delete obj;
+    }
+
+    SECTION("top scorers of the league and of a team")
+    {
+        world_cup_t *obj = new world_cup_t();
+        REQUIRE(obj->add_team(1, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->add_team(2, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(11, 1, 1, 5, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(12, 1, 1, 5, 2, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(13, 1, 1, 1, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(21, 2, 1, 9, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(22, 2, 1, 5, 0, false) == StatusType::SUCCESS);
+        int output[8];
+        REQUIRE(obj->get_top_k_scorers(-1, 3, output).ans() == 3);
+        REQUIRE(output[0] == 21);
+        REQUIRE(output[1] == 22);
+        REQUIRE(output[2] == 11);
+        REQUIRE(obj->get_top_k_scorers(1, 8, output).ans() == 3);
+        REQUIRE(output[0] == 11);
+        REQUIRE(output[1] == 12);
+        REQUIRE(output[2] == 13);
+
+        // the first k ids of get_all_players, read from its end
+        int all[5];
+        REQUIRE(obj->get_all_players(-1, all) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_k_scorers(-1, 5, output).ans() == 5);
+        for (int i = 0; i < 5; i++)
+        {
+            REQUIRE(output[i] == all[4 - i]);
+        }
+
+        REQUIRE(obj->update_player_stats(13, 1, 10, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->get_top_k_scorers(-1, 1, output).ans() == 1);
+        REQUIRE(output[0] == 13);
+        delete obj;
+    }
+}
+
+TEST_CASE("get_all_players_page")
+{
+    SECTION("invalid input")
+    {
+        world_cup_t *obj = new world_cup_t();
+        PlayersCursor cursor;
+        int output[4];
+        REQUIRE(obj->get_all_players_page(0, &cursor, 4, output).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_all_players_page(-1, nullptr, 4, output).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_all_players_page(-1, &cursor, 0, output).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_all_players_page(-1, &cursor, 4, nullptr).status() == StatusType::INVALID_INPUT);
+        REQUIRE(obj->get_all_players_page(1, &cursor, 4, output).status() == StatusType::FAILURE);
+        output_t<int> res = obj->get_all_players_page(-1, &cursor, 4, output);
+        REQUIRE(res.status() == StatusType::SUCCESS);
+        REQUIRE(res.ans() == 0);
+        REQUIRE(cursor.done);
+        delete obj;
+    }
+
+    SECTION("pages cover get_all_players")
+    {
+        world_cup_t *obj = new world_cup_t();
+        REQUIRE(obj->add_team(1, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->add_team(2, 0) == StatusType::SUCCESS);
+        const int players = 500;
+        bool added = true;
+        for (int playerId = 1; playerId <= players; playerId++)
+        {
+            added = added && obj->add_player(playerId, 1 + playerId % 2, 1, playerId % 13, playerId % 3, false) == StatusType::SUCCESS;
+        }
+        REQUIRE(added);
+        int all[players];
+        REQUIRE(obj->get_all_players(-1, all) == StatusType::SUCCESS);
+        int paged[players];
+        int count = 0;
+        int pages = 0;
+        PlayersCursor cursor;
+        while (!cursor.done)
+        {
+            output_t<int> res = obj->get_all_players_page(-1, &cursor, 64, paged + count);
+            REQUIRE(res.status() == StatusType::SUCCESS);
+            count += res.ans();
+            pages++;
+        }
+        REQUIRE(count == players);
+        REQUIRE(pages == 8);
+        bool same = true;
+        for (int i = 0; i < players; i++)
+        {
+            same = same && paged[i] == all[i];
+        }
+        REQUIRE(same);
+        delete obj;
+    }
+
+    SECTION("a cursor survives changes between pages")
+    {
+        world_cup_t *obj = new world_cup_t();
+        REQUIRE(obj->add_team(1, 0) == StatusType::SUCCESS);
+        for (int playerId = 1; playerId <= 6; playerId++)
+        {
+            REQUIRE(obj->add_player(playerId, 1, 1, playerId, 0, false) == StatusType::SUCCESS);
+        }
+        int output[6];
+        PlayersCursor cursor;
+        REQUIRE(obj->get_all_players_page(1, &cursor, 2, output).ans() == 2);
+        REQUIRE(output[0] == 1);
+        REQUIRE(output[1] == 2);
+        REQUIRE(!cursor.done);
+        REQUIRE(obj->remove_player(2) == StatusType::SUCCESS);
+        REQUIRE(obj->remove_player(3) == StatusType::SUCCESS);
+        REQUIRE(obj->get_all_players_page(1, &cursor, 2, output).ans() == 2);
+        REQUIRE(output[0] == 4);
+        REQUIRE(output[1] == 5);
+        REQUIRE(obj->get_all_players_page(1, &cursor, 2, output).ans() == 1);
+        REQUIRE(output[0] == 6);
+        REQUIRE(cursor.done);
+
+        PlayersCursor from(Stats(4, 0, 0));
+        REQUIRE(obj->get_all_players_page(1, &from, 6, output).ans() == 3);
+        REQUIRE(output[0] == 4);
+        REQUIRE(output[2] == 6);
+        delete obj;
+    }
+}
+
+// feeds text to a CommandReader through a pipe, the way a driver reads standard input
+static bool openReader(CommandReader& reader, const std::string& text)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return false;
+    }
+    bool written = write(fds[1], text.data(), text.size()) == (ssize_t)text.size();
+    close(fds[1]);
+    bool opened = written && reader.open(fds[0]);
+    close(fds[0]);
+    return opened;
+}
+
+TEST_CASE("CommandReader")
+{
+    SECTION("every command and its arguments")
+    {
+        CommandReader reader;
+        REQUIRE(openReader(reader, "add_team 1 -2\n  add_player 5 1 3 2 1 true\r\nget_all_players_count -1\n"
+                                   "knockout_winner +4 2147483647 get_team_points 7\nunite_teams 1 2 3"));
+        Command cmd;
+        REQUIRE(reader.next(cmd) == CommandReader::Status::COMMAND);
+        REQUIRE(cmd.type == CommandType::ADD_TEAM);
+        REQUIRE(cmd.args[0] == 1);
+        REQUIRE(cmd.args[1] == -2);
+        REQUIRE(reader.next(cmd) == CommandReader::Status::COMMAND);
+        REQUIRE(cmd.type == CommandType::ADD_PLAYER);
+        REQUIRE(cmd.args[4] == 1);
+        REQUIRE(cmd.goalKeeper);
+        REQUIRE(reader.next(cmd) == CommandReader::Status::COMMAND);
+        REQUIRE(cmd.type == CommandType::GET_ALL_PLAYERS_COUNT);
+        REQUIRE(cmd.args[0] == -1);
+        REQUIRE(reader.next(cmd) == CommandReader::Status::COMMAND);
+        REQUIRE(cmd.type == CommandType::KNOCKOUT_WINNER);
+        REQUIRE(cmd.args[0] == 4);
+        REQUIRE(cmd.args[1] == 2147483647);
+        REQUIRE(reader.next(cmd) == CommandReader::Status::COMMAND);
+        REQUIRE(cmd.type == CommandType::GET_TEAM_POINTS);
+        REQUIRE(reader.next(cmd) == CommandReader::Status::COMMAND);
+        REQUIRE(cmd.type == CommandType::UNITE_TEAMS);
+        REQUIRE(cmd.args[2] == 3);
+        REQUIRE(reader.next(cmd) == CommandReader::Status::END);
+        REQUIRE(reader.next(cmd) == CommandReader::Status::END);
+
+        for (int type = 0; type < Command::TYPES; type++)
+        {
+            CommandReader names;
+            std::string text = Command::name((CommandType)type);
+            for (int i = 0; i < Command::argCount((CommandType)type); i++)
+            {
+                text += " 1";
+            }
+            REQUIRE(openReader(names, text + ((type == (int)CommandType::ADD_PLAYER) ? " false" : "")));
+            REQUIRE(names.next(cmd) == CommandReader::Status::COMMAND);
+            REQUIRE((int)cmd.type == type);
+        }
+    }
+
+    SECTION("malformed input")
+    {
+        Command cmd;
+        CommandReader unknown;
+        REQUIRE(openReader(unknown, "add_teams 1 2"));
+        REQUIRE(unknown.next(cmd) == CommandReader::Status::UNKNOWN_COMMAND);
+        REQUIRE(std::string(unknown.getToken(), unknown.getTokenLength()) == "add_teams");
+        CommandReader missing;
+        REQUIRE(openReader(missing, "play_match 1"));
+        REQUIRE(missing.next(cmd) == CommandReader::Status::INVALID_FORMAT);
+        CommandReader overflow;
+        REQUIRE(openReader(overflow, "remove_team 2147483648"));
+        REQUIRE(overflow.next(cmd) == CommandReader::Status::INVALID_FORMAT);
+        CommandReader notBool;
+        REQUIRE(openReader(notBool, "add_player 1 1 1 1 1 yes"));
+        REQUIRE(notBool.next(cmd) == CommandReader::Status::INVALID_FORMAT);
+        CommandReader empty;
+        REQUIRE(openReader(empty, " \n"));
+        REQUIRE(empty.next(cmd) == CommandReader::Status::END);
+    }
+}
+
+// everything left to read from fd, once the writer is done with it
+static std::string readToEnd(int fd)
+{
+    std::string text;
+    char chunk[4096];
+    ssize_t got;
+    while ((got = read(fd, chunk, sizeof(chunk))) > 0)
+    {
+        text.append(chunk, got);
+    }
+    return text;
+}
+
+TEST_CASE("OutputSink")
+{
+    SECTION("lines match main23a1's")
+    {
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        {
+            OutputSink out(fds[1]);
+            out.writeLine(CommandType::ADD_TEAM, StatusType::SUCCESS);
+            out.writeLine(CommandType::REMOVE_PLAYER, StatusType::ALLOCATION_ERROR);
+            out.writeLine(CommandType::GET_TEAM_POINTS, output_t<int>(-2147483647 - 1));
+            out.writeLine(CommandType::KNOCKOUT_WINNER, output_t<int>(StatusType::FAILURE));
+            out.writeLine(CommandType::GET_ALL_PLAYERS, StatusType::INVALID_INPUT);
+            out.writeIdLine(0);
+            out.writeIdLine(2147483647);
+            out.write("Invalid input format\n", 21);
+            REQUIRE(out.flush());
+        }
+        close(fds[1]);
+        std::ostringstream expected;
+        expected << "add_team: SUCCESS\n" << "remove_player: ALLOCATION_ERROR\n" << "get_team_points: SUCCESS, -2147483648\n"
+                 << "knockout_winner: FAILURE\n" << "get_all_players: INVALID_INPUT\n" << "0\n2147483647\n" << "Invalid input format\n";
+        REQUIRE(readToEnd(fds[0]) == expected.str());
+        close(fds[0]);
+    }
+
+    SECTION("output bigger than the buffer")
+    {
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        std::string expected;
+        std::string text;
+        // the reader drains the pipe while the sink fills it
+        pid_t child = fork();
+        REQUIRE(child >= 0);
+        if (child == 0)
+        {
+            close(fds[0]);
+            OutputSink out(fds[1]);
+            for (int id = 0; id < 300000; id++)
+            {
+                out.writeIdLine(id * 7 - 1000);
+            }
+            std::string big(3 << 20, 'x');
+            out.write(big.data(), big.size());
+            _exit(out.flush() ? 0 : 1);
+        }
+        close(fds[1]);
+        text = readToEnd(fds[0]);
+        close(fds[0]);
+        int status = 1;
+        REQUIRE(waitpid(child, &status, 0) == child);
+        REQUIRE(status == 0);
+        for (int id = 0; id < 300000; id++)
+        {
+            expected += std::to_string(id * 7 - 1000) + "\n";
+        }
+        expected += std::string(3 << 20, 'x');
+        REQUIRE(text == expected);
+    }
+}
+
+// the contents of a file, trying the path from the repository root and from the tests directory
+static bool readFile(const std::string& path, std::string& text)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file)
+    {
+        file.open(("../" + path).c_str(), std::ios::binary);
+    }
+    if (!file)
+    {
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    text = contents.str();
+    return true;
+}
+
+// a scratch file holding text, open for reading and writing and already unlinked. -1 on failure
+static int scratchFile(const std::string& text)
+{
+    char path[] = "/tmp/WorldCupTestsXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    unlink(path);
+    if (write(fd, text.data(), text.size()) != (ssize_t)text.size() || lseek(fd, 0, SEEK_SET) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool sameCommand(const Command& a, const Command& b)
+{
+    if (a.type != b.type || a.goalKeeper != b.goalKeeper)
+    {
+        return false;
+    }
+    for (int i = 0; i < Command::argCount(a.type); i++)
+    {
+        if (a.args[i] != b.args[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("binary command log")
+{
+    SECTION("records round trip")
+    {
+        Command cmd;
+        cmd.type = CommandType::ADD_PLAYER;
+        cmd.goalKeeper = true;
+        int values[Command::MAX_ARGS] = {0, -1, 2147483647, -2147483647 - 1, 64};
+        for (int i = 0; i < Command::MAX_ARGS; i++)
+        {
+            cmd.args[i] = values[i];
+        }
+        unsigned char record[CommandLog::MAX_RECORD];
+        int length = CommandLog::encode(cmd, record);
+        REQUIRE(length == 1 + 1 + 1 + 5 + 5 + 2);
+        Command decoded;
+        REQUIRE(CommandLog::decode(record, record + length, decoded) == length);
+        REQUIRE(sameCommand(cmd, decoded));
+        REQUIRE(CommandLog::decode(record, record + length - 1, decoded) == 0);
+        unsigned char bad = 0x80 | (unsigned char)CommandType::PLAY_MATCH;
+        REQUIRE(CommandLog::decode(&bad, &bad + 1, decoded) == 0);
+    }
+
+    SECTION("the wacky corpus replays from binary logs")
+    {
+        int replayed = 0;
+        bool same = true;
+        for (int i = 1; i <= 100; i++)
+        {
+            std::string text;
+            std::string expected;
+            if (!readFile("wacky/in/input" + std::to_string(i) + ".in", text) ||
+                !readFile("wacky/out/output" + std::to_string(i) + ".out", expected))
+            {
+                continue;
+            }
+            std::vector<Command> commands;
+            std::string binary((const char*)CommandLog::MAGIC, CommandLog::MAGIC_SIZE);
+            int textFd = scratchFile(text);
+            REQUIRE(textFd >= 0);
+            {
+                CommandReader reader;
+                REQUIRE(reader.open(textFd));
+                REQUIRE(!reader.isBinary());
+                Command cmd;
+                unsigned char record[CommandLog::MAX_RECORD];
+                while (reader.next(cmd) == CommandReader::Status::COMMAND)
+                {
+                    commands.push_back(cmd);
+                    binary.append((const char*)record, CommandLog::encode(cmd, record));
+                }
+            }
+            close(textFd);
+
+            int binaryFd = scratchFile(binary);
+            int outputFd = scratchFile("");
+            REQUIRE(binaryFd >= 0);
+            REQUIRE(outputFd >= 0);
+            {
+                CommandReader reader;
+                REQUIRE(reader.open(binaryFd));
+                REQUIRE(reader.isBinary());
+                world_cup_t *obj = new world_cup_t();
+                OutputSink out(outputFd);
+                CommandRunner runner(obj, &out);
+                Command cmd;
+                size_t decoded = 0;
+                CommandReader::Status status;
+                while ((status = reader.next(cmd)) == CommandReader::Status::COMMAND)
+                {
+                    same = same && decoded < commands.size() && sameCommand(cmd, commands[decoded]);
+                    decoded++;
+                    runner.run(cmd);
+                }
+                same = same && status == CommandReader::Status::END && decoded == commands.size();
+                out.flush();
+                delete obj;
+            }
+            close(binaryFd);
+            lseek(outputFd, 0, SEEK_SET);
+            same = same && readToEnd(outputFd) == expected;
+            close(outputFd);
+            replayed++;
+        }
+        REQUIRE(replayed == 100);
+        REQUIRE(same);
+    }
+}
+
+static Command makeCommand(CommandType type, int a0 = 0, int a1 = 0, int a2 = 0, int a3 = 0, int a4 = 0, bool goalKeeper = false)
+{
+    Command cmd;
+    cmd.type = type;
+    cmd.goalKeeper = goalKeeper;
+    cmd.args[0] = a0;
+    cmd.args[1] = a1;
+    cmd.args[2] = a2;
+    cmd.args[3] = a3;
+    cmd.args[4] = a4;
+    return cmd;
+}
+
+TEST_CASE("execute_batch")
+{
+    world_cup_t *obj = new world_cup_t();
+
+    SECTION("commands run in order, as single calls would")
+    {
+        Command cmds[] = {
+            makeCommand(CommandType::ADD_TEAM, 1, 10),
+            makeCommand(CommandType::ADD_TEAM, 1, 5),
+            makeCommand(CommandType::ADD_PLAYER, 11, 1, 3, 4, 0, true),
+            makeCommand(CommandType::ADD_PLAYER, 12, 1, 2, 7, 1),
+            makeCommand(CommandType::ADD_PLAYER, 13, 2, 1, 0, 0),
+            makeCommand(CommandType::GET_TOP_SCORER, 1),
+            makeCommand(CommandType::UPDATE_PLAYER_STATS, 11, 1, 5, 0),
+            makeCommand(CommandType::GET_TOP_SCORER, -1),
+            makeCommand(CommandType::GET_ALL_PLAYERS_COUNT, 1),
+            makeCommand(CommandType::GET_ALL_PLAYERS, 1),
+            makeCommand(CommandType::GET_ALL_PLAYERS, 2),
+            makeCommand(CommandType::GET_ALL_PLAYERS, 0),
+            makeCommand(CommandType::GET_NUM_PLAYED_GAMES, 11),
+            makeCommand(CommandType::REMOVE_TEAM, 1),
+            makeCommand(CommandType::GET_TEAM_POINTS, 1),
+        };
+        const size_t n = sizeof(cmds) / sizeof(cmds[0]);
+        Result out[n];
+        REQUIRE(obj->execute_batch(cmds, n, out) == StatusType::SUCCESS);
+
+        StatusType statuses[n] = {
+            StatusType::SUCCESS, StatusType::FAILURE, StatusType::SUCCESS, StatusType::SUCCESS, StatusType::FAILURE,
+            StatusType::SUCCESS, StatusType::SUCCESS, StatusType::SUCCESS, StatusType::SUCCESS, StatusType::SUCCESS,
+            StatusType::FAILURE, StatusType::INVALID_INPUT, StatusType::SUCCESS, StatusType::FAILURE, StatusType::SUCCESS,
+        };
+        for (size_t i = 0; i < n; i++)
+        {
+            REQUIRE(out[i].type == cmds[i].type);
+            REQUIRE(out[i].status == statuses[i]);
+        }
+        REQUIRE(out[5].answer == 12);
+        REQUIRE(out[7].answer == 11);
+        REQUIRE(out[8].answer == 2);
+        REQUIRE(out[9].playerCount == 2);
+        REQUIRE(out[9].players[0] == 12);
+        REQUIRE(out[9].players[1] == 11);
+        REQUIRE(out[10].players == nullptr);
+        REQUIRE(out[12].answer == 4);
+        REQUIRE(out[14].answer == 10);
+        for (size_t i = 0; i < n; i++)
+        {
+            delete[] out[i].players;
+        }
+    }
+
+    SECTION("a team without players")
+    {
+        Command cmds[] = {
+            makeCommand(CommandType::ADD_TEAM, 3, 0),
+            makeCommand(CommandType::GET_ALL_PLAYERS, 3),
+        };
+        Result out[2];
+        REQUIRE(obj->execute_batch(cmds, 2, out) == StatusType::SUCCESS);
+        REQUIRE(out[1].status == StatusType::SUCCESS);
+        REQUIRE(out[1].playerCount == 0);
+        REQUIRE(out[1].players == nullptr);
+    }
+
+    SECTION("invalid input")
+    {
+        Result out[1];
+        REQUIRE(obj->execute_batch(nullptr, 1, out) == StatusType::INVALID_INPUT);
+        Command cmd = makeCommand(CommandType::ADD_TEAM, 1, 0);
+        REQUIRE(obj->execute_batch(&cmd, 1, nullptr) == StatusType::INVALID_INPUT);
+        REQUIRE(obj->execute_batch(nullptr, 0, nullptr) == StatusType::SUCCESS);
+        REQUIRE(obj->get_team_points(1).status() == StatusType::FAILURE);
+    }
+
+    delete obj;
+}
+
+// a record for testing AVLTree on its own, with a sum aggregate over its value
+struct TestRecord
+{
+    int value;
+    int getValue() const { return value; }
+};
+
+typedef SumAggregate<TestRecord, int, &TestRecord::getValue> TestSum;
+typedef AVLTree<TestRecord, int, TestSum> TestTree;
+typedef TreeNode<TestRecord, int, TestSum> TestNode;
+
+// walk the subtree of node, checking its parent links, heights, balance factors, sizes and sums, and append its keys
+// to keys in order. returns the height of the subtree, or -1 if any of them is off
+static int checkSubtree(const TestNode *node, const TestNode *parent, vector<int> &keys)
+{
+    if (node == nullptr)
+    {
+        return 0;
+    }
+    if (node->parent != parent)
+    {
+        return -1;
+    }
+    int leftHeight = checkSubtree(node->left, node, keys);
+    keys.push_back(node->key);
+    int rightHeight = checkSubtree(node->right, node, keys);
+    if (leftHeight < 0 || rightHeight < 0 || leftHeight - rightHeight > 1 || rightHeight - leftHeight > 1)
+    {
+        return -1;
+    }
+    int height = max(leftHeight, rightHeight) + 1;
+    int leftSize = (node->left == nullptr) ? 0 : node->left->size;
+    int rightSize = (node->right == nullptr) ? 0 : node->right->size;
+    int leftSum = (node->left == nullptr) ? 0 : node->left->aggregate;
+    int rightSum = (node->right == nullptr) ? 0 : node->right->aggregate;
+    if (node->height != height || node->size != leftSize + rightSize + 1 ||
+        node->aggregate != leftSum + node->data->value + rightSum)
+    {
+        return -1;
+    }
+    return height;
+}
+
+// check every invariant of tree and that it holds exactly expected, in order
+static bool checkTree(const TestTree &tree, const vector<int> &expected)
+{
+    vector<int> keys;
+    if (checkSubtree(tree.root, nullptr, keys) < 0 || tree.getSize() != (int)keys.size())
+    {
+        return false;
+    }
+    return keys == expected;
+}
+
+TEST_CASE("AVLTree invariants")
+{
+    const int KEYS = 4096;
+    vector<TestRecord> records(KEYS);
+    for (int i = 0; i < KEYS; i++)
+    {
+        records[i].value = i % 7 - 3;
+    }
+    TestTree tree;
+
+    SECTION("random inserts and removes keep the tree balanced, linked and sized")
+    {
+        mt19937 random(2023);
+        set<int> expected;
+        bool same = true;
+        for (int op = 1; op <= 40000; op++)
+        {
+            int key = random() % KEYS;
+            // lean towards inserting early and removing late, so the tree grows big and then drains
+            bool insert = (int)(random() % 40000) >= op;
+            if (insert)
+            {
+                same = ((tree.tryInsert(&records[key], key) != nullptr) == expected.insert(key).second) && same;
+            }
+            else
+            {
+                same = (tree.tryRemove(key) == (expected.erase(key) == 1)) && same;
+            }
+            if (op % 500 == 0)
+            {
+                REQUIRE(same);
+                REQUIRE(checkTree(tree, vector<int>(expected.begin(), expected.end())));
+                int position = 1;
+                bool ranked = true;
+                for (set<int>::iterator it = expected.begin(); it != expected.end(); ++it, ++position)
+                {
+                    ranked = ranked && tree.rank(*it) == position && tree.select(position)->key == *it;
+                }
+                REQUIRE(ranked);
+                REQUIRE(tree.select(position) == nullptr);
+            }
+        }
+    }
+
+    SECTION("long runs of removals rebalance all the way up")
+    {
+        vector<int> expected;
+        for (int key = 0; key < KEYS; key++)
+        {
+            REQUIRE(tree.tryInsert(&records[key], key) != nullptr);
+            expected.push_back(key);
+        }
+        REQUIRE(checkTree(tree, expected));
+        // remove from the left end, then every third key, then from the right end. each run skews the tree
+        // towards one side and forces rotations at several levels
+        for (int key = 0; key < KEYS / 4; key++)
+        {
+            REQUIRE(tree.tryRemove(key));
+        }
+        expected.erase(expected.begin(), expected.begin() + KEYS / 4);
+        REQUIRE(checkTree(tree, expected));
+        vector<int> kept;
+        for (int key : expected)
+        {
+            if (key % 3 == 0)
+            {
+                REQUIRE(tree.tryRemove(key));
+            }
+            else
+            {
+                kept.push_back(key);
+            }
+        }
+        expected = kept;
+        REQUIRE(checkTree(tree, expected));
+        while (expected.size() > 10)
+        {
+            REQUIRE(tree.tryRemove(expected.back()));
+            expected.pop_back();
+            if (expected.size() % 97 == 0)
+            {
+                REQUIRE(checkTree(tree, expected));
+            }
+        }
+        REQUIRE(checkTree(tree, expected));
+        REQUIRE(!tree.tryRemove(KEYS));
+        REQUIRE(checkTree(tree, expected));
+    }
+}
+
+// link the keys keys of records into tree
+static bool fillTree(TestTree &tree, vector<TestRecord> &records, const vector<int> &keys)
+{
+    bool inserted = true;
+    for (int key : keys)
+    {
+        inserted = (tree.tryInsert(&records[key], key) != nullptr) && inserted;
+    }
+    return inserted;
+}
+
+// the keys from first to last, step apart
+static vector<int> keyRange(int first, int last, int step)
+{
+    vector<int> keys;
+    for (int key = first; key <= last; key += step)
+    {
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+static vector<int> concat(vector<int> left, const vector<int> &right)
+{
+    left.insert(left.end(), right.begin(), right.end());
+    return left;
+}
+
+TEST_CASE("AVLTree join split and merge")
+{
+    const int KEYS = 5000;
+    vector<TestRecord> records(KEYS);
+    for (int i = 0; i < KEYS; i++)
+    {
+        records[i].value = i % 11 - 5;
+    }
+    // the trees share a pool, as join, split and merge require
+    NodePool<TestRecord, int, TestSum> pool;
+    TestTree left(&pool);
+    TestTree right(&pool);
+    TestTree joined(&pool);
+
+    SECTION("join trees of very different heights")
+    {
+        vector<int> small = keyRange(1, 3, 1);
+        vector<int> big = keyRange(200, 4999, 1);
+        TestNode *pivot = joined.createNode(&records[100], 100);
+        REQUIRE(pivot != nullptr);
+        REQUIRE(fillTree(left, records, small));
+        REQUIRE(fillTree(right, records, big));
+        joined.join(left, pivot, right);
+        REQUIRE(checkTree(joined, concat(concat(small, {100}), big)));
+        REQUIRE(joined.aggregate(0, KEYS) == joined.root->aggregate);
+        REQUIRE(checkTree(left, {}));
+        REQUIRE(checkTree(right, {}));
+
+        TestTree rejoined(&pool);
+        TestNode *second = joined.createNode(&records[150], 150);
+        REQUIRE(second != nullptr);
+        TestTree lower(&pool);
+        TestTree higher(&pool);
+        REQUIRE(fillTree(higher, records, keyRange(151, 160, 1)));
+        rejoined.join(lower, second, higher); // an empty side
+        REQUIRE(checkTree(rejoined, keyRange(150, 160, 1)));
+    }
+
+    SECTION("split at a key in the tree and between keys")
+    {
+        vector<int> odd = keyRange(1, 4999, 2);
+        TestTree tree(&pool);
+        REQUIRE(fillTree(tree, records, odd));
+
+        TestNode *found = tree.split(2501, left, right);
+        REQUIRE(found != nullptr);
+        REQUIRE(found->key == 2501);
+        REQUIRE(found->left == nullptr);
+        REQUIRE(found->right == nullptr);
+        REQUIRE(found->parent == nullptr);
+        REQUIRE(found->size == 1);
+        REQUIRE(found->aggregate == records[2501].value);
+        REQUIRE(checkTree(tree, {}));
+        REQUIRE(checkTree(left, keyRange(1, 2499, 2)));
+        REQUIRE(checkTree(right, keyRange(2503, 4999, 2)));
+        joined.join(left, found, right);
+        REQUIRE(checkTree(joined, odd));
+
+        REQUIRE(joined.split(1000, left, right) == nullptr);
+        REQUIRE(checkTree(joined, {}));
+        REQUIRE(checkTree(left, keyRange(1, 999, 2)));
+        REQUIRE(checkTree(right, keyRange(1001, 4999, 2)));
+        int leftSum = 0;
+        for (int key : keyRange(1, 999, 2))
+        {
+            leftSum += records[key].value;
+        }
+        int rightSum = 0;
+        for (int key : keyRange(1001, 4999, 2))
+        {
+            rightSum += records[key].value;
+        }
+        REQUIRE(left.aggregate(0, KEYS) == leftSum);
+        REQUIRE(right.aggregate(0, KEYS) == rightSum);
+
+        TestTree below(&pool);
+        TestTree above(&pool);
+        REQUIRE(left.split(0, below, above) == nullptr); // below every key
+        REQUIRE(checkTree(below, {}));
+        REQUIRE(checkTree(above, keyRange(1, 999, 2)));
+        TestTree empty(&pool);
+        TestTree all(&pool);
+        REQUIRE(right.split(KEYS, all, empty) == nullptr); // above every key
+        REQUIRE(checkTree(all, keyRange(1001, 4999, 2)));
+        REQUIRE(checkTree(empty, {}));
+    }
+
+    SECTION("merge disjoint, interleaved and empty trees")
+    {
+        vector<int> low = keyRange(1, 700, 1);
+        vector<int> high = keyRange(3000, 3040, 1);
+        REQUIRE(fillTree(left, records, high));
+        REQUIRE(fillTree(right, records, low));
+        REQUIRE(TestTree::mergeScratchSize(left, right) == 0);
+        REQUIRE(TestTree::merge(left, right, joined)); // the higher keys first
+        REQUIRE(checkTree(joined, concat(low, high)));
+        REQUIRE(checkTree(left, {}));
+        REQUIRE(checkTree(right, {}));
+
+        vector<int> even = keyRange(0, 4998, 2);
+        vector<int> odd = keyRange(1, 4999, 2);
+        TestTree evens(&pool);
+        TestTree odds(&pool);
+        TestTree interleaved(&pool);
+        REQUIRE(fillTree(evens, records, even));
+        REQUIRE(fillTree(odds, records, odd));
+        REQUIRE(TestTree::mergeScratchSize(evens, odds) == KEYS);
+        REQUIRE(TestTree::merge(evens, odds, interleaved));
+        REQUIRE(checkTree(interleaved, keyRange(0, 4999, 1)));
+        REQUIRE(checkTree(evens, {}));
+        REQUIRE(checkTree(odds, {}));
+
+        TestTree moved(&pool);
+        REQUIRE(TestTree::merge(interleaved, left, moved)); // one side empty
+        REQUIRE(checkTree(moved, keyRange(0, 4999, 1)));
+        REQUIRE(checkTree(interleaved, {}));
+
+        TestTree otherPool;
+        TestTree notMerged(&pool);
+        REQUIRE(fillTree(otherPool, records, {1, 2}));
+        REQUIRE(!TestTree::merge(otherPool, right, notMerged));
+        REQUIRE(checkTree(otherPool, {1, 2}));
+    }
+}
+
+// runs operations on a world while tracking the games every player should have played, to check what the
+// union-find over the team sets reports
+struct GamesTracker
+{
+    world_cup_t *world;
+    map<int, vector<int>> members; // the players of every team
+    map<int, int> games;           // the games every player played
+
+    bool addPlayer(int playerId, int teamId, int gamesPlayed)
+    {
+        members[teamId].push_back(playerId);
+        games[playerId] = gamesPlayed;
+        return world->add_player(playerId, teamId, gamesPlayed, 0, 0, playerId % 100 == 0) == StatusType::SUCCESS;
+    }
+
+    bool playMatch(int teamId1, int teamId2)
+    {
+        for (int playerId : members[teamId1])
+        {
+            games[playerId]++;
+        }
+        for (int playerId : members[teamId2])
+        {
+            games[playerId]++;
+        }
+        return world->play_match(teamId1, teamId2) == StatusType::SUCCESS;
+    }
+
+    bool updatePlayer(int playerId, int gamesPlayed)
+    {
+        games[playerId] += gamesPlayed;
+        return world->update_player_stats(playerId, gamesPlayed, 1, 0) == StatusType::SUCCESS;
+    }
+
+    bool removePlayer(int playerId, int teamId)
+    {
+        vector<int> &team = members[teamId];
+        team.erase(find(team.begin(), team.end(), playerId));
+        games.erase(playerId);
+        return world->remove_player(playerId) == StatusType::SUCCESS;
+    }
+
+    bool unite(int teamId1, int teamId2, int newTeamId)
+    {
+        vector<int> united = members[teamId1];
+        united.insert(united.end(), members[teamId2].begin(), members[teamId2].end());
+        members.erase(teamId1);
+        members.erase(teamId2);
+        members[newTeamId] = united;
+        return world->unite_teams(teamId1, teamId2, newTeamId) == StatusType::SUCCESS;
+    }
+
+    // every player's games, exactly
+    bool check()
+    {
+        for (const pair<const int, int> &player : games)
+        {
+            output_t<int> played = world->get_num_played_games(player.first);
+            if (played.status() != StatusType::SUCCESS || played.ans() != player.second)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+TEST_CASE("games played through chains of unites")
+{
+    world_cup_t *obj = new world_cup_t();
+    GamesTracker tracker = {obj, {}, {}};
+    for (int teamId = 1; teamId <= 8; teamId++)
+    {
+        REQUIRE(obj->add_team(teamId, 0) == StatusType::SUCCESS);
+        for (int i = 0; i < 11; i++) // enough players and a goalkeeper to play matches
+        {
+            REQUIRE(tracker.addPlayer(teamId * 100 + i, teamId, i % 4));
+        }
+    }
+    REQUIRE(tracker.check());
+
+    SECTION("each team joins the team united so far")
+    {
+        // the united team alternately takes a new id, keeps its own and takes the id of the team joining it
+        int current = 1;
+        for (int teamId = 2; teamId <= 8; teamId++)
+        {
+            REQUIRE(tracker.playMatch(current, teamId));
+            if (teamId < 8)
+            {
+                REQUIRE(tracker.playMatch(teamId, teamId + 1));
+            }
+            REQUIRE(tracker.updatePlayer(teamId * 100, 2));
+            REQUIRE(tracker.updatePlayer(tracker.members[current].front(), 1));
+            REQUIRE(tracker.check());
+            int newTeamId = (teamId % 3 == 0) ? 100 + teamId : (teamId % 3 == 1) ? current : teamId;
+            REQUIRE(tracker.unite(current, teamId, newTeamId));
+            current = newTeamId;
+            REQUIRE(tracker.check());
+            // a player joining the united team counts only the games played from now on
+            REQUIRE(tracker.addPlayer(1000 + teamId, current, 1));
+            if (teamId < 8)
+            {
+                REQUIRE(tracker.playMatch(current, teamId + 1));
+            }
+            REQUIRE(tracker.check());
+        }
+    }
+
+    SECTION("two chains are united into one")
+    {
+        REQUIRE(tracker.unite(1, 2, 12));
+        REQUIRE(tracker.playMatch(12, 3));
+        REQUIRE(tracker.unite(12, 3, 13));
+        REQUIRE(tracker.updatePlayer(201, 4));
+        REQUIRE(tracker.unite(5, 6, 56));
+        REQUIRE(tracker.playMatch(56, 7));
+        REQUIRE(tracker.unite(7, 56, 7));
+        REQUIRE(tracker.playMatch(13, 7));
+        REQUIRE(tracker.check());
+        REQUIRE(tracker.unite(13, 7, 99));
+        REQUIRE(tracker.playMatch(99, 4));
+        REQUIRE(tracker.playMatch(99, 8));
+        REQUIRE(tracker.addPlayer(1001, 99, 5));
+        REQUIRE(tracker.check());
+        REQUIRE(tracker.removePlayer(105, 99));
+        REQUIRE(tracker.unite(4, 99, 4));
+        REQUIRE(tracker.playMatch(4, 8));
+        REQUIRE(tracker.check());
+    }
+
+    delete obj;
+}
+
+// the ids get_all_players returns for teamId
+static vector<int> allPlayers(world_cup_t *obj, int teamId)
+{
+    output_t<int> count = obj->get_all_players_count(teamId);
+    vector<int> ids(count.status() == StatusType::SUCCESS ? count.ans() : 0);
+    if (obj->get_all_players(teamId, ids.empty() ? nullptr : ids.data()) != StatusType::SUCCESS)
+    {
+        ids.clear();
+    }
+    return ids;
+}
+
+// a node unlinked from its tree, with nothing left of its place there
+static bool isDetached(const TestNode &node)
+{
+    return node.left == nullptr && node.right == nullptr && node.parent == nullptr && node.height == 1 &&
+           node.size == 1 && node.aggregate == node.data->value;
+}
+
+TEST_CASE("intrusive nodes relink cleanly")
+{
+    SECTION("unlinked nodes are detached and link again, at the same key or a new one")
+    {
+        const int KEYS = 64;
+        vector<TestRecord> records(KEYS);
+        vector<TestNode> nodes(KEYS);
+        TestTree tree(nullptr);
+        vector<int> expected;
+        for (int i = 0; i < KEYS; i++)
+        {
+            records[i].value = i;
+            nodes[i].data = &records[i];
+            nodes[i].key = i;
+            REQUIRE(tree.link(&nodes[i]));
+            expected.push_back(i);
+        }
+        REQUIRE(!tree.link(&nodes[7])); // already in the tree
+        REQUIRE(checkTree(tree, expected));
+
+        // the root and inner nodes swap places with their successors when unlinked
+        int rootKey = tree.root->key;
+        REQUIRE((rootKey != 40 && rootKey != 8 && rootKey != 0 && rootKey != 63));
+        for (int i : {rootKey, 40, 8, 0, 63})
+        {
+            REQUIRE(tree.unlink(&nodes[i]) == &nodes[i]);
+            REQUIRE(isDetached(nodes[i]));
+            expected.erase(find(expected.begin(), expected.end(), i));
+            REQUIRE(checkTree(tree, expected));
+        }
+        REQUIRE(tree.link(&nodes[40]));
+        expected.insert(lower_bound(expected.begin(), expected.end(), 40), 40);
+        REQUIRE(checkTree(tree, expected));
+
+        // move a node to a new key, and then back
+        REQUIRE(isDetached(*tree.unlink(&nodes[20])));
+        nodes[20].key = 100;
+        REQUIRE(tree.link(&nodes[20]));
+        expected.erase(find(expected.begin(), expected.end(), 20));
+        expected.push_back(100);
+        REQUIRE(checkTree(tree, expected));
+        REQUIRE(isDetached(*tree.unlink(&nodes[20])));
+        nodes[20].key = 20;
+        REQUIRE(tree.link(&nodes[20]));
+        expected.pop_back();
+        expected.insert(lower_bound(expected.begin(), expected.end(), 20), 20);
+        REQUIRE(checkTree(tree, expected));
+        tree.clear(false);
+    }
+
+    SECTION("players removed, added again and moved by their stats")
+    {
+        world_cup_t *obj = new world_cup_t();
+        REQUIRE(obj->add_team(1, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->add_team(2, 0) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(1, 1, 1, 5, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(2, 1, 1, 3, 1, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(3, 1, 1, 3, 0, false) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(4, 1, 1, 0, 0, true) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(5, 1, 1, 1, 0, false) == StatusType::SUCCESS);
+        REQUIRE(allPlayers(obj, 1) == vector<int>({4, 5, 2, 3, 1}));
+
+        // the same id again, in a new place
+        REQUIRE(obj->remove_player(3) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(3, 1, 1, 6, 0, false) == StatusType::SUCCESS);
+        REQUIRE(allPlayers(obj, 1) == vector<int>({4, 5, 2, 1, 3}));
+        REQUIRE(obj->get_top_scorer(1).ans() == 3);
+        REQUIRE(obj->get_all_players_count(1).ans() == 5);
+
+        // and in another team
+        REQUIRE(obj->remove_player(3) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(3, 2, 1, 0, 2, false) == StatusType::SUCCESS);
+        REQUIRE(allPlayers(obj, 1) == vector<int>({4, 5, 2, 1}));
+        REQUIRE(allPlayers(obj, 2) == vector<int>({3}));
+        REQUIRE(allPlayers(obj, -1) == vector<int>({3, 4, 5, 2, 1}));
+        REQUIRE(obj->get_top_scorer(1).ans() == 1);
+
+        // update_player_stats takes the player out of both stats trees and puts it back
+        REQUIRE(obj->update_player_stats(4, 1, 10, 0) == StatusType::SUCCESS);
+        REQUIRE(allPlayers(obj, 1) == vector<int>({5, 2, 1, 4}));
+        REQUIRE(allPlayers(obj, -1) == vector<int>({3, 5, 2, 1, 4}));
+        REQUIRE(obj->update_player_stats(4, 1, 0, 0) == StatusType::SUCCESS); // back in the same place
+        REQUIRE(allPlayers(obj, -1) == vector<int>({3, 5, 2, 1, 4}));
+        REQUIRE(obj->update_player_stats(5, 1, 2, 0) == StatusType::SUCCESS); // next to player 2, by cards
+        REQUIRE(allPlayers(obj, 1) == vector<int>({2, 5, 1, 4}));
+        REQUIRE(allPlayers(obj, -1) == vector<int>({3, 2, 5, 1, 4}));
+        REQUIRE(obj->get_top_scorer(-1).ans() == 4);
+
+        REQUIRE(obj->remove_player(4) == StatusType::SUCCESS);
+        REQUIRE(obj->add_player(4, 1, 1, 2, 0, true) == StatusType::SUCCESS);
+        REQUIRE(allPlayers(obj, -1) == vector<int>({3, 4, 2, 5, 1}));
+        REQUIRE(obj->get_all_players_count(-1).ans() == 5);
+        REQUIRE(obj->get_all_players_count(1).ans() == 4);
+        REQUIRE(obj->get_top_scorer(-1).ans() == 1);
+        delete obj;
+    }
 }
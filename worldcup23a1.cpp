@@ -1,22 +1,33 @@
 #include "worldcup23a1.h"
 #include "Team.h"
 #include "Player.h"
+#include <new>
 
 world_cup_t::world_cup_t():
 	topScorer(nullptr)
 {
-	this->teams = new AVLTree<Team, int>();
+	this->teamSets = new ObjectPool<TeamSet>();
+	this->knockout = new Knockout();
+	this->knockoutCache = new KnockoutCache();
+	this->teams = new AVLTree<Team, int, TeamAggregate>();
 	this->kosherTeams = new AVLTree<Team, int>();
-	this->playersById = new AVLTree<Player, int>();
-	this->playersByStats = new AVLTree<Player, Stats>();
+	this->teamsByScore = new AVLTree<Team, MatchScore>(nullptr);
+	this->playersById = new AVLTree<Player, int>(nullptr);
+	this->playersByStats = new AVLTree<Player, Stats>(nullptr);
 }
 
 world_cup_t::~world_cup_t()
 {
-	delete this->playersById;
-	delete this->playersByStats;
 	delete this->kosherTeams;
+	delete this->teamsByScore;
+	this->teams->clear(true); //delete the teams
 	delete this->teams;
+	delete this->playersByStats;
+	this->playersById->clear(true); //delete the players, and with them their nodes
+	delete this->playersById;
+	delete this->knockout;
+	delete this->knockoutCache;
+	delete this->teamSets; //every set was freed along with the last team or player holding it
 }
 
 
@@ -25,14 +36,23 @@ StatusType world_cup_t::add_team(int teamId, int points)
 	if(teamId <= 0 || points < 0) {
 		return StatusType::INVALID_INPUT;
 	}
-	shared_ptr<Team> team = shared_ptr<Team>(new Team(teamId, points));
-	try{
-		this->teams->insert(team, teamId);
-	}
-	catch(const AVLTree<Team, int>::KeyAlreadyExists& e){
+	if(this->teams->tryFind(teamId) != nullptr) {
 		return StatusType::FAILURE;
 	}
-	
+	TeamSet* set = this->teamSets->create(this->teamSets);
+	if(set == nullptr) {
+		return StatusType::ALLOCATION_ERROR;
+	}
+	Team* team = new (std::nothrow) Team(teamId, points, set);
+	if(team == nullptr) {
+		this->teamSets->destroy(set);
+		return StatusType::ALLOCATION_ERROR;
+	}
+	if(this->teams->tryInsert(team, teamId) == nullptr) {
+		delete team; //frees the set too
+		return StatusType::ALLOCATION_ERROR;
+	}
+	this->teamsByScore->link(team->getScoreNode());
 	return StatusType::SUCCESS;
 }
 
@@ -41,16 +61,14 @@ StatusType world_cup_t::remove_team(int teamId)
 	if (teamId <= 0){
 		return StatusType::INVALID_INPUT;
 	}
-	try{
-		TreeNode<Team, int>* teamNode = this->teams->findNode(teamId);
-		if (teamNode->data->getPlayersNum() != 0){
-			return StatusType::FAILURE;
-		}
-		this->teams->remove(teamId);
-	}
-	catch(const AVLTree<Team, int>::NodeNotFound& e){
+	TreeNode<Team, int, TeamAggregate>* teamNode = this->teams->tryFind(teamId);
+	if (teamNode == nullptr || teamNode->data->getPlayersNum() != 0){
 		return StatusType::FAILURE;
 	}
+	Team* team = teamNode->data;
+	this->teams->tryRemove(teamId);
+	this->teamsByScore->unlink(team->getScoreNode());
+	delete team;
 	return StatusType::SUCCESS;
 }
 
@@ -61,69 +79,65 @@ StatusType world_cup_t::add_player(int playerId, int teamId, int gamesPlayed,
 	(gamesPlayed == 0 && (goals > 0 || cards > 0))){
 		return StatusType::INVALID_INPUT;
 	}
-	try{
-		shared_ptr<Team> team = this->teams->findNode(teamId)->data;
-		shared_ptr<Player> player = shared_ptr<Player>(new Player(playerId, teamId, team, gamesPlayed - team->getGamesPlayed(), goals, cards, goalKeeper));
-		
-		bool isKosher = team->isKosher();
-		Stats stats = player->getStats();
-		this->playersById->insert(player, playerId);
-		this->playersByStats->insert(player, stats);
-		
-		TreeNode<Player, Stats>* pred = this->playersByStats->findPredecessor(stats);
-		TreeNode<Player, Stats>* succ = this->playersByStats->findSuccessor(stats);
-		if(pred != nullptr) {
-			player->setPre(pred->data);
-			pred->data->setSucc(player);
-		}
-		else {
-			player->setPre(nullptr);
-		}
-		if(succ != nullptr) {
-			player->setSucc(succ->data);
-			succ->data->setPre(player);
-		}
-		else {
-			player->setSucc(nullptr);
+	TreeNode<Team, int, TeamAggregate>* teamNode = this->teams->tryFind(teamId);
+	if(teamNode == nullptr || this->playersById->tryFind(playerId) != nullptr) {
+		return StatusType::FAILURE;
+	}
+	Team* team = teamNode->data;
+	bool isKosher = team->isKosher();
+	//reserve the team's kosher node before anything changes, so running out of memory leaves the world as it was
+	TreeNode<Team, int>* kosherNode = nullptr;
+	if(!isKosher && team->isKosherWith(1, goalKeeper ? 1 : 0)) {
+		kosherNode = this->kosherTeams->createNode(team, teamId);
+		if(kosherNode == nullptr) {
+			return StatusType::ALLOCATION_ERROR;
 		}
-		
-		team->getPlayersById()->insert(player, playerId);
-		team->getPlayersByStats()->insert(player, stats);
-		team->addTotalCards(cards);
-		team->addTotalGoals(goals);
-		team->addPlayersNum(1);
-		if(goalKeeper) {
-			team->addGoalKeepers(1);
+	}
+	Player* player = new (std::nothrow) Player(playerId, team->getSet(), gamesPlayed - team->getGamesPlayed(), goals, cards, goalKeeper);
+	if(player == nullptr) {
+		if(kosherNode != nullptr) {
+			this->kosherTeams->destroyNode(kosherNode);
 		}
-		
-		if (!isKosher && team->isKosher()){ // Team was not kosher and now is - add to kosher tree
-			this->kosherTeams->insert(team, teamId);
-			TreeNode<Team, int>* teamPre = this->kosherTeams->findPredecessor(teamId);
-			TreeNode<Team, int>* teamSucc = this->kosherTeams->findSuccessor(teamId);
-			if(teamPre != nullptr){
-				teamPre->data->setNextKosher(team);
-			}
-			if(teamSucc != nullptr){
-				team->setNextKosher(teamSucc->data);
-			}
-			else{
-				team->setNextKosher(nullptr);
-			}
+		return StatusType::ALLOCATION_ERROR;
+	}
+	
+	Stats stats = player->getStats();
+	//the nodes are part of the player, so linking them cannot fail
+	this->playersById->link(player->getIdNode());
+	this->playersByStats->link(player->getStatsNode());
+	team->getPlayersById()->link(player->getTeamIdNode());
+	team->getPlayersByStats()->link(player->getTeamStatsNode());
+	
+	team->addTotalCards(cards);
+	team->addTotalGoals(goals);
+	team->addPlayersNum(1);
+	if(goalKeeper) {
+		team->addGoalKeepers(1);
+	}
+	if(team->getTopScorer() == nullptr || stats > team->getTopScorer()->getStats()) { 
+		team->setTopScorer(player);
+	}
+	if(this->topScorer == nullptr || stats > this->topScorer->getStats()) {
+		this->topScorer = player;
+	}
+	this->refreshTeam(team);
+	if(team->isKosher() && (!isKosher || goals != cards)) { //the team joined the knockouts or its match score changed
+		this->knockoutCache->invalidate(teamId);
+	}
+	
+	if (kosherNode != nullptr){ // Team was not kosher and now is - add to kosher tree. the team is not in it, so this cannot fail
+		TreeNode<Team, int>* teamPre;
+		TreeNode<Team, int>* teamSucc;
+		this->kosherTeams->link(kosherNode, teamPre, teamSucc);
+		if(teamPre != nullptr){
+			teamPre->data->setNextKosher(team);
 		}
-		if(team->getTopScorer() == nullptr || stats > team->getTopScorer()->getStats()) { 
-			team->setTopScorer(player);
+		if(teamSucc != nullptr){
+			team->setNextKosher(teamSucc->data);
 		}
-		if(this->topScorer == nullptr || stats > this->topScorer->getStats()) {
-			this->topScorer = player;
+		else{
+			team->setNextKosher(nullptr);
 		}
-		
-		
-	}
-	catch (const std::bad_alloc& e) {
-		return StatusType::ALLOCATION_ERROR;
-	}
-	catch(const std::exception& e) {
-		return StatusType::FAILURE;
 	}
 	return StatusType::SUCCESS;
 }
@@ -133,49 +147,44 @@ StatusType world_cup_t::remove_player(int playerId)
 	if(playerId <= 0) {
 		return StatusType::INVALID_INPUT;
 	}
-	try {
-		shared_ptr<Player> player = this->playersById->findNode(playerId)->data;
-		shared_ptr<Team> team = player->getTeam();
-		bool isKosher = team->isKosher();
-		Stats playerStats = player->getStats();
-		if (this->topScorer == player){
-			this->topScorer = player->getPre();
-		}
-		if(team->getTopScorer() == player) {
-			TreeNode<Player, Stats>* pred = team->getPlayersByStats()->findPredecessor(player->getStats());
-			if(pred != nullptr) {
-				team->setTopScorer(pred->data);
-			}
-			else {
-				team->setTopScorer(nullptr);
-			}
-		}
-		if (player->getPre() != nullptr)
-			player->getPre()->setSucc(player->getSucc());
-		if (player->getSucc() != nullptr)
-			player->getSucc()->setPre(player->getPre());
-		this->playersById->remove(playerId);
-		this->playersByStats->remove(playerStats);
-		team->getPlayersById()->remove(playerId);
-		team->getPlayersByStats()->remove(playerStats);
-		if(player->isGoalKeeper()) {
-			team->addGoalKeepers(-1);
-		}
-		team->addTotalCards(-(player->getCards())); //add player's cards to team's total cards count
-		team->addTotalGoals(-(player->getGoals())); //add player's goals to team's total goals count
-		team->addPlayersNum(-1);
-		if(isKosher && !team->isKosher()) { // If was kosher and now not - remove from kosher tree
-			TreeNode<Team, int>* teamPre = this->kosherTeams->findPredecessor(team->getID());
-			if(teamPre != nullptr){
-				teamPre->data->setNextKosher(team->getNextKosher());
-			}
-			this->kosherTeams->remove(team->getID());
-			team->setNextKosher(nullptr);
-		}
-	}
-	catch(const std::exception& e) {
+	TreeNode<Player, int>* playerNode = this->playersById->tryFind(playerId);
+	if(playerNode == nullptr) {
 		return StatusType::FAILURE;
 	}
+	Player* player = playerNode->data;
+	Team* team = player->getTeam();
+	bool isKosher = team->isKosher();
+	if (this->topScorer == player){
+		TreeNode<Player, Stats>* pred = AVLTree<Player, Stats>::prev(player->getStatsNode());
+		this->topScorer = (pred != nullptr) ? pred->data : nullptr;
+	}
+	if(team->getTopScorer() == player) {
+		TreeNode<Player, Stats>* pred = AVLTree<Player, Stats>::prev(player->getTeamStatsNode());
+		team->setTopScorer((pred != nullptr) ? pred->data : nullptr);
+	}
+	this->playersById->unlink(player->getIdNode());
+	this->playersByStats->unlink(player->getStatsNode());
+	team->getPlayersById()->unlink(player->getTeamIdNode());
+	team->getPlayersByStats()->unlink(player->getTeamStatsNode());
+	if(player->isGoalKeeper()) {
+		team->addGoalKeepers(-1);
+	}
+	team->addTotalCards(-(player->getCards())); //add player's cards to team's total cards count
+	team->addTotalGoals(-(player->getGoals())); //add player's goals to team's total goals count
+	team->addPlayersNum(-1);
+	this->refreshTeam(team);
+	if(isKosher && (!team->isKosher() || player->getGoals() != player->getCards())) { //the team left the knockouts or its match score changed
+		this->knockoutCache->invalidate(team->getID());
+	}
+	delete player;
+	if(isKosher && !team->isKosher()) { // If was kosher and now not - remove from kosher tree
+		TreeNode<Team, int>* teamPre = this->kosherTeams->findPredecessor(team->getID());
+		if(teamPre != nullptr){
+			teamPre->data->setNextKosher(team->getNextKosher());
+		}
+		this->kosherTeams->tryRemove(team->getID());
+		team->setNextKosher(nullptr);
+	}
 	return StatusType::SUCCESS;
 }
 
@@ -185,63 +194,32 @@ StatusType world_cup_t::update_player_stats(int playerId, int gamesPlayed,
 	if(playerId <= 0 || gamesPlayed < 0 || scoredGoals < 0 || cardsReceived < 0) {
 		return StatusType::INVALID_INPUT;
 	}
-	try {
-		shared_ptr<Player> player = this->playersById->findNode(playerId)->data;
-		shared_ptr<Team> team = player->getTeam();
-		Stats stats = player->getStats();
-
-		this->playersByStats->remove(stats);
-		team->getPlayersByStats()->remove(stats);
+	TreeNode<Player, int>* playerNode = this->playersById->tryFind(playerId);
+	if(playerNode == nullptr) {
+		return StatusType::FAILURE;
+	}
+	Player* player = playerNode->data;
+	Team* team = player->getTeam();
 
-		player->updateStats(gamesPlayed, scoredGoals, cardsReceived);
-		Stats newStats = player->getStats();
-		
-		team->addTotalCards(cardsReceived); //add player's cards to team's total cards count
-		team->addTotalGoals(scoredGoals); //add player's goals to team's total goals count
+	this->playersByStats->unlink(player->getStatsNode());
+	team->getPlayersByStats()->unlink(player->getTeamStatsNode());
 
-		if(team->getTopScorer() == nullptr || newStats > team->getTopScorer()->getStats()) { 
-			team->setTopScorer(player);
-		}
-		if(this->topScorer == nullptr || newStats > this->topScorer->getStats()) {
-			this->topScorer = player;
-		}
+	player->updateStats(gamesPlayed, scoredGoals, cardsReceived);
+	
+	team->addTotalCards(cardsReceived); //add player's cards to team's total cards count
+	team->addTotalGoals(scoredGoals); //add player's goals to team's total goals count
+	if(team->isKosher() && scoredGoals != cardsReceived) {
+		this->knockoutCache->invalidate(team->getID());
+	}
 
-		team->getPlayersByStats()->insert(player, newStats);
-		this->playersByStats->insert(player, newStats);
-
-		shared_ptr<Player> pred = player->getPre();
-		shared_ptr<Player> succ = player->getSucc();
-		TreeNode<Player, Stats>* newPredNode = this->playersByStats->findPredecessor(newStats);
-		TreeNode<Player, Stats>* newSuccNode = this->playersByStats->findSuccessor(newStats);
-		shared_ptr<Player> newPred = nullptr;
-		shared_ptr<Player> newSucc = nullptr; 
-		if(newPredNode != nullptr){
-			newPred = newPredNode->data;
-		}
-		if(newSuccNode != nullptr){
-			newSucc = newSuccNode->data;
-		}
+	team->getPlayersByStats()->link(player->getTeamStatsNode());
+	this->playersByStats->link(player->getStatsNode());
 
-		if (pred != newPred){
-			if (pred == nullptr)
-				succ->setPre(nullptr);
-			else if(succ == nullptr)
-				pred->setPre(nullptr);
-			else{
-				pred->setSucc(succ);
-				succ->setPre(pred);
-			}
-			player->setPre(newPred);
-			player->setSucc(newSucc);
-			if(newPred != nullptr)
-				newPred->setSucc(player);
-			if(newSucc != nullptr)
-				newSucc->setPre(player);
-		}
-	}
-	catch(const std::exception& e) {
-		return StatusType::FAILURE;
-	}
+	//cards lower a player's stats, so the top scorers are taken from the trees rather than only promoted
+	AVLTree<Player, Stats>* teamPlayers = team->getPlayersByStats();
+	team->setTopScorer(teamPlayers->select(teamPlayers->getSize())->data);
+	this->topScorer = this->playersByStats->select(this->playersByStats->getSize())->data;
+	this->refreshTeam(team); //after the top scorer, whose stats the aggregates compare
 	return StatusType::SUCCESS;
 }
 
@@ -250,30 +228,34 @@ StatusType world_cup_t::play_match(int teamId1, int teamId2)
 	if(teamId1 <= 0 || teamId2 <= 0 || teamId1 == teamId2) {
 		return StatusType::INVALID_INPUT;
 	}
-	try {
-		shared_ptr<Team> team1 = this->teams->findNode(teamId1)->data;
-		shared_ptr<Team> team2 = this->teams->findNode(teamId2)->data;
-		if(team1->getPlayersNum() < 11 || team1->getGoalKeepers() < 1 || team2->getPlayersNum() < 11 || team2->getGoalKeepers() < 1) {
-			return StatusType::FAILURE;
-		}
-		int team1GameScore = team1->getPoints() + team1->getTotalGoals() - team1->getTotalCards();
-		int team2GameScore = team2->getPoints() + team2->getTotalGoals() - team2->getTotalCards();
-		if(team1GameScore > team2GameScore) { //team1 wins
-			team1->addPoints(3);
-		}
-		else if(team1GameScore < team2GameScore){ //team2 wins
-			team2->addPoints(3);
-		}
-		else { //tie
-			team1->addPoints(1);
-			team2->addPoints(1);
-		}
-		team1->addGamesPlayed(1);
-		team2->addGamesPlayed(1);
+	TreeNode<Team, int, TeamAggregate>* teamNode1 = this->teams->tryFind(teamId1);
+	TreeNode<Team, int, TeamAggregate>* teamNode2 = this->teams->tryFind(teamId2);
+	if(teamNode1 == nullptr || teamNode2 == nullptr) {
+		return StatusType::FAILURE;
 	}
-	catch(const std::exception& e) {
+	Team* team1 = teamNode1->data;
+	Team* team2 = teamNode2->data;
+	if(team1->getPlayersNum() < 11 || team1->getGoalKeepers() < 1 || team2->getPlayersNum() < 11 || team2->getGoalKeepers() < 1) {
 		return StatusType::FAILURE;
 	}
+	int team1GameScore = team1->getMatchScore();
+	int team2GameScore = team2->getMatchScore();
+	if(team1GameScore > team2GameScore) { //team1 wins
+		team1->addPoints(3);
+	}
+	else if(team1GameScore < team2GameScore){ //team2 wins
+		team2->addPoints(3);
+	}
+	else { //tie
+		team1->addPoints(1);
+		team2->addPoints(1);
+	}
+	team1->addGamesPlayed(1);
+	team2->addGamesPlayed(1);
+	this->refreshTeam(team1);
+	this->refreshTeam(team2);
+	this->knockoutCache->invalidate(teamId1); //both teams can play, so both are kosher and got points
+	this->knockoutCache->invalidate(teamId2);
 	return StatusType::SUCCESS;
 }
 
@@ -282,13 +264,11 @@ output_t<int> world_cup_t::get_num_played_games(int playerId)
 	if(playerId <= 0) {
 		return output_t<int>(StatusType::INVALID_INPUT);
 	}
-	try {
-		return output_t<int>(this->playersById->findNode(playerId)->data->getGamesPlayed());
-	}
-	catch(const std::exception& e) {
+	TreeNode<Player, int>* playerNode = this->playersById->tryFind(playerId);
+	if(playerNode == nullptr) {
 		return output_t<int>(StatusType::FAILURE);
 	}
-	return 22;
+	return output_t<int>(playerNode->data->getGamesPlayed());
 }
 
 output_t<int> world_cup_t::get_team_points(int teamId)
@@ -296,13 +276,11 @@ output_t<int> world_cup_t::get_team_points(int teamId)
 	if(teamId <= 0) {
 		return output_t<int>(StatusType::INVALID_INPUT);
 	}
-	try { 
-		return output_t<int>(this->teams->findNode(teamId)->data->getPoints());
-	}
-	catch(const std::exception& e) {
+	TreeNode<Team, int, TeamAggregate>* teamNode = this->teams->tryFind(teamId);
+	if(teamNode == nullptr) {
 		return output_t<int>(StatusType::FAILURE);
 	}
-	return 30003;
+	return output_t<int>(teamNode->data->getPoints());
 }
 
 StatusType world_cup_t::unite_teams(int teamId1, int teamId2, int newTeamId)
@@ -310,98 +288,111 @@ StatusType world_cup_t::unite_teams(int teamId1, int teamId2, int newTeamId)
 	if(teamId1 <= 0 || teamId2 <= 0 || newTeamId <= 0 || teamId1 == teamId2) {
 		return StatusType::INVALID_INPUT;
 	}
-	try {
-		if(newTeamId != teamId1 && newTeamId != teamId2){
-			this->teams->findNode(newTeamId);
-			return StatusType::FAILURE; //the key was found and therefore it's a failure
-		}
+	if(newTeamId != teamId1 && newTeamId != teamId2 && this->teams->tryFind(newTeamId) != nullptr){
+		return StatusType::FAILURE; //the key was found and therefore it's a failure
 	}
-	catch(const AVLTree<Team, int>::NodeNotFound& e){} //catch KeyNotFound exception, and ignore (Ignore = Good)
-	try {
-		shared_ptr<Team> team1 = this->teams->findNode(teamId1)->data;
-		shared_ptr<Team> team2 = this->teams->findNode(teamId2)->data;
-		shared_ptr<Team> newTeam = shared_ptr<Team>(new Team(newTeamId, team1->getPoints() + team2->getPoints()));
-		newTeam->setPlayersNum(team1->getPlayersNum() + team2->getPlayersNum());
-		newTeam->addGoalKeepers(team1->getGoalKeepers() + team2->getGoalKeepers());
-		newTeam->addTotalGoals(team1->getTotalGoals() + team2->getTotalGoals());
-		newTeam->addTotalCards(team1->getTotalCards() + team2->getTotalCards());
-		if(team1->getTopScorer() == nullptr){
-			newTeam->setTopScorer(team2->getTopScorer());
-		}
-		else if(team2->getTopScorer() == nullptr){
-			newTeam->setTopScorer(team2->getTopScorer());
-		}
-		else if(team1->getTopScorer()->getGoals() > team2->getTopScorer()->getGoals()) {
-			newTeam->setTopScorer(team1->getTopScorer());
-		}
-		else {
-			newTeam->setTopScorer(team2->getTopScorer());
-		}
-		int arr1_size = team1->getPlayersById()->getSize();
-        int arr2_size = team2->getPlayersById()->getSize();
-        
-        TreeNode<Player, int>** arr1 = new TreeNode<Player, int>* [arr1_size]; //first tree sorted array
-        TreeNode<Player, int>** arr2 = new TreeNode<Player, int>* [arr2_size]; //second tree sorted array
-        
-        team1->getPlayersById()->treeToArray(arr1, team1->getPlayersById()->root, 0);
-        team1->getPlayersById()->treeToArray(arr2, team2->getPlayersById()->root, 0);
-		shared_ptr<Player> currPlayer;
-		for (int i=0; i<arr1_size; i++){
-			currPlayer = arr1[i]->data;
-			currPlayer->addGamesPlayed(currPlayer->getGamesPlayed() - currPlayer->gamesWithoutTeam());
-			currPlayer->setTeam(newTeam);
-		}
-		for (int i=0; i<arr2_size; i++){
-			currPlayer = arr2[i]->data;
-			currPlayer->addGamesPlayed(currPlayer->getGamesPlayed() - currPlayer->gamesWithoutTeam());
-			currPlayer->setTeam(newTeam);
-		}
-		delete[] arr1;
-		delete[] arr2;
-		AVLTree<Player, int>::merge(*team1->getPlayersById(), *team2->getPlayersById(), *newTeam->getPlayersById()); //merge player tree by id
-		AVLTree<Player, Stats>::merge(*team1->getPlayersByStats(), *team2->getPlayersByStats(), *newTeam->getPlayersByStats()); //merge players tree by stats
-		
-		if(team1->isKosher()){
-			TreeNode<Team, int>* team1Pre = this->kosherTeams->findPredecessor(team1->getID());
-			if(team1Pre != nullptr){
-				team1Pre->data->setNextKosher(team1->getNextKosher());
-			}
-			team1->setNextKosher(nullptr);
-			this->kosherTeams->remove(teamId1);
+	TreeNode<Team, int, TeamAggregate>* teamNode1 = this->teams->tryFind(teamId1);
+	TreeNode<Team, int, TeamAggregate>* teamNode2 = this->teams->tryFind(teamId2);
+	if(teamNode1 == nullptr || teamNode2 == nullptr) {
+		return StatusType::FAILURE;
+	}
+	Team* team1 = teamNode1->data;
+	Team* team2 = teamNode2->data;
+	Team* newTeam = new (std::nothrow) Team(newTeamId, team1->getPoints() + team2->getPoints(), nullptr); //takes over the united set below
+	if(newTeam == nullptr) {
+		return StatusType::ALLOCATION_ERROR;
+	}
+	newTeam->setPlayersNum(team1->getPlayersNum() + team2->getPlayersNum());
+	newTeam->addGoalKeepers(team1->getGoalKeepers() + team2->getGoalKeepers());
+	newTeam->addTotalGoals(team1->getTotalGoals() + team2->getTotalGoals());
+	newTeam->addTotalCards(team1->getTotalCards() + team2->getTotalCards());
+	if(team1->getTopScorer() == nullptr){
+		newTeam->setTopScorer(team2->getTopScorer());
+	}
+	else if(team2->getTopScorer() == nullptr){
+		newTeam->setTopScorer(team1->getTopScorer());
+	}
+	else if(team1->getTopScorer()->getStats() > team2->getTopScorer()->getStats()) {
+		newTeam->setTopScorer(team1->getTopScorer());
+	}
+	else {
+		newTeam->setTopScorer(team2->getTopScorer());
+	}
+	//reserve everything that can fail to allocate before team1 and team2 are touched, so a failure leaves them as they were
+	TreeNode<Team, int, TeamAggregate>* newTeamNode = this->teams->createNode(newTeam, newTeamId);
+	TreeNode<Team, int>* newKosherNode = newTeam->isKosher() ? this->kosherTeams->createNode(newTeam, newTeamId) : nullptr;
+	AVLTree<Player, int>* byId1 = team1->getPlayersById();
+	AVLTree<Player, int>* byId2 = team2->getPlayersById();
+	AVLTree<Player, Stats>* byStats1 = team1->getPlayersByStats();
+	AVLTree<Player, Stats>* byStats2 = team2->getPlayersByStats();
+	int idScratchSize = AVLTree<Player, int>::mergeScratchSize(*byId1, *byId2);
+	int statsScratchSize = AVLTree<Player, Stats>::mergeScratchSize(*byStats1, *byStats2);
+	TreeNode<Player, int>** idScratch = (idScratchSize > 0) ? new (std::nothrow) TreeNode<Player, int>*[idScratchSize] : nullptr;
+	TreeNode<Player, Stats>** statsScratch = (statsScratchSize > 0) ? new (std::nothrow) TreeNode<Player, Stats>*[statsScratchSize] : nullptr;
+	if(newTeamNode == nullptr || (newTeam->isKosher() && newKosherNode == nullptr) ||
+	(idScratchSize > 0 && idScratch == nullptr) || (statsScratchSize > 0 && statsScratch == nullptr)) {
+		if(newTeamNode != nullptr) {
+			this->teams->destroyNode(newTeamNode);
+		}
+		if(newKosherNode != nullptr) {
+			this->kosherTeams->destroyNode(newKosherNode);
+		}
+		delete[] idScratch;
+		delete[] statsScratch;
+		delete newTeam;
+		return StatusType::ALLOCATION_ERROR;
+	}
+	//nothing below allocates. the player trees are intrusive, so merging them relinks the players' own nodes
+	AVLTree<Player, int>::merge(*byId1, *byId2, *newTeam->getPlayersById(), idScratch); //O(log n) if the id ranges do not interleave
+	AVLTree<Player, Stats>::merge(*byStats1, *byStats2, *newTeam->getPlayersByStats(), statsScratch);
+	delete[] idScratch;
+	delete[] statsScratch;
+	newTeam->setSet(TeamSet::unite(team1->getSet(), team2->getSet())); //the players follow through their sets
+	
+	if(team1->isKosher()){
+		TreeNode<Team, int>* team1Pre = this->kosherTeams->findPredecessor(team1->getID());
+		if(team1Pre != nullptr){
+			team1Pre->data->setNextKosher(team1->getNextKosher());
 		}
-		
-		if(team2->isKosher()){
-			TreeNode<Team, int>* team2Pre = this->kosherTeams->findPredecessor(team2->getID());
-			if(team2Pre != nullptr){
-				team2Pre->data->setNextKosher(team2->getNextKosher());
-			}
-			team2->setNextKosher(nullptr);
-			this->kosherTeams->remove(teamId2);
+		team1->setNextKosher(nullptr);
+		this->kosherTeams->tryRemove(teamId1);
+		this->knockoutCache->invalidate(teamId1);
+	}
+	
+	if(team2->isKosher()){
+		TreeNode<Team, int>* team2Pre = this->kosherTeams->findPredecessor(team2->getID());
+		if(team2Pre != nullptr){
+			team2Pre->data->setNextKosher(team2->getNextKosher());
 		}
+		team2->setNextKosher(nullptr);
+		this->kosherTeams->tryRemove(teamId2);
+		this->knockoutCache->invalidate(teamId2);
+	}
 
-		this->teams->remove(teamId1);
-		this->teams->remove(teamId2);
-		this->teams->insert(newTeam, newTeamId);
-		if (newTeam->isKosher()){
-			this->kosherTeams->insert(newTeam, newTeamId);
-			TreeNode<Team, int>* newTeamPre = this->kosherTeams->findPredecessor(newTeamId);
-			TreeNode<Team, int>* newTeamSucc = this->kosherTeams->findSuccessor(newTeamId);
-			if(newTeamPre != nullptr){
-				newTeamPre->data->setNextKosher(newTeam);
-			}
-			if(newTeamSucc != nullptr){
-				newTeam->setNextKosher(newTeamSucc->data);
-			}
-			else{
-				newTeam->setNextKosher(nullptr);
-			}
+	this->teams->tryRemove(teamId1);
+	this->teams->tryRemove(teamId2);
+	this->teamsByScore->unlink(team1->getScoreNode());
+	this->teamsByScore->unlink(team2->getScoreNode());
+	delete team1;
+	delete team2;
+	//newTeamId is free now that team1 and team2 are gone, so linking the reserved nodes cannot fail
+	this->teams->link(newTeamNode);
+	newTeam->updateScoreKey();
+	this->teamsByScore->link(newTeam->getScoreNode());
+	if (newKosherNode != nullptr){
+		this->knockoutCache->invalidate(newTeamId);
+		TreeNode<Team, int>* newTeamPre;
+		TreeNode<Team, int>* newTeamSucc;
+		this->kosherTeams->link(newKosherNode, newTeamPre, newTeamSucc);
+		if(newTeamPre != nullptr){
+			newTeamPre->data->setNextKosher(newTeam);
+		}
+		if(newTeamSucc != nullptr){
+			newTeam->setNextKosher(newTeamSucc->data);
+		}
+		else{
+			newTeam->setNextKosher(nullptr);
 		}
-	}
-	catch(const std::bad_alloc& e) {
-		return StatusType::ALLOCATION_ERROR;
-	}
-	catch(const std::exception& e) {
-		return StatusType::FAILURE;
 	}
 	return StatusType::SUCCESS;
 }
@@ -416,16 +407,11 @@ output_t<int> world_cup_t::get_top_scorer(int teamId)
 			return output_t<int>(this->topScorer->getId());
 		return output_t<int>(StatusType::FAILURE);
 	}
-	try {
-		shared_ptr<Team> team = this->teams->findNode(teamId)->data;
-		if(team->getTopScorer() != nullptr)
-			return output_t<int>(team->getTopScorer()->getId());
-		return output_t<int>(StatusType::FAILURE);
+	TreeNode<Team, int, TeamAggregate>* teamNode = this->teams->tryFind(teamId);
+	if(teamNode != nullptr && teamNode->data->getTopScorer() != nullptr) {
+		return output_t<int>(teamNode->data->getTopScorer()->getId());
 	}
-	catch(std::exception& e) {
-		return output_t<int>(StatusType::FAILURE);
-	}
-	return 2008;
+	return output_t<int>(StatusType::FAILURE);
 }
 
 output_t<int> world_cup_t::get_all_players_count(int teamId)
@@ -436,29 +422,40 @@ output_t<int> world_cup_t::get_all_players_count(int teamId)
 	if(teamId < 0) {
 		return this->playersById->getSize();
 	}
-	try{
-		return output_t<int>(this->teams->findNode(teamId)->data->getPlayersById()->getSize());
-	}
-	catch(std::exception& e){
+	TreeNode<Team, int, TeamAggregate>* teamNode = this->teams->tryFind(teamId);
+	if(teamNode == nullptr) {
 		return output_t<int>(StatusType::FAILURE);
 	}
-    static int i = 0;
-    return (i++==0) ? 11 : 2;
+	return output_t<int>(teamNode->data->getPlayersById()->getSize());
 }
 
-static int treeToIdArray(TreeNode<Player, Stats>* root, int *const output, int i) {
-	if(root == nullptr) {
-		return i;
+//the players of the league if teamId is negative, otherwise the players of the team. nullptr if there is no such team
+AVLTree<Player, Stats>* world_cup_t::getPlayersByStats(int teamId) const
+{
+	if(teamId < 0) {
+		return this->playersByStats;
 	}
-	if(root->left != nullptr) {
-		i = treeToIdArray(root->left, output, i);
+	TreeNode<Team, int, TeamAggregate>* teamNode = this->teams->tryFind(teamId);
+	if(teamNode == nullptr) {
+		return nullptr;
 	}
-	output[i] = root->data->getId();
-	i++;
-	if(root->right != nullptr) {
-		i = treeToIdArray(root->right, output, i);
+	return teamNode->data->getPlayersByStats();
+}
+
+//recalculate the range aggregates over team, and its place in the league table, after its goals, cards,
+//points or top scorer changed. O(log n)
+void world_cup_t::refreshTeam(Team* team)
+{
+	TreeNode<Team, int, TeamAggregate>* teamNode = this->teams->tryFind(team->getID());
+	if(teamNode != nullptr) {
+		this->teams->refresh(teamNode);
+	}
+	TreeNode<Team, MatchScore>* scoreNode = team->getScoreNode();
+	if(scoreNode->key.score != team->getMatchScore()) {
+		this->teamsByScore->unlink(scoreNode);
+		team->updateScoreKey();
+		this->teamsByScore->link(scoreNode);
 	}
-	return i;
 }
 
 StatusType world_cup_t::get_all_players(int teamId, int *const output)
@@ -466,23 +463,17 @@ StatusType world_cup_t::get_all_players(int teamId, int *const output)
 	if(teamId == 0) {
 		return StatusType::INVALID_INPUT;
 	}
-	try {
-		AVLTree<Player, Stats>* tree;
-		if(teamId < 0) {
-			tree = this->playersByStats;
-		}
-		else {
-			tree = this->teams->findNode(teamId)->data->getPlayersByStats();
-		}
-		if (tree->getSize() != 0 && output == nullptr){
-			return StatusType::INVALID_INPUT;
-		}
-		treeToIdArray(tree->root, output, 0);
-		return StatusType::SUCCESS;
-	}
-	catch(const std::exception& e) {
+	AVLTree<Player, Stats>* tree = this->getPlayersByStats(teamId);
+	if(tree == nullptr) {
 		return StatusType::FAILURE;
 	}
+	if (tree->getSize() != 0 && output == nullptr){
+		return StatusType::INVALID_INPUT;
+	}
+	int i = 0;
+	for(TreeNode<Player, Stats>* node = tree->select(1); node != nullptr; node = AVLTree<Player, Stats>::next(node)) {
+		output[i++] = node->data->getId();
+	}
 	return StatusType::SUCCESS;
 }
 
@@ -494,120 +485,327 @@ output_t<int> world_cup_t::get_closest_player(int playerId, int teamId)
 	if (this->playersById->getSize() == 1){ // Only one player in system
 		return output_t<int>(StatusType::FAILURE);
 	}
-	try{
-		shared_ptr<Player> playerNode = this->teams->findNode(teamId)->data->getPlayersById()->findNode(playerId)->data;
-		shared_ptr<Player> pre = playerNode->getPre();
-		shared_ptr<Player> succ = playerNode->getSucc();
-		Stats playerStats = playerNode->getStats();
-		int closest;
-		if(pre == nullptr && succ == nullptr){
-			return output_t<int>(StatusType::FAILURE);
-		}
-		else if(pre == nullptr) {
-			closest = succ->getId();
-		}
-		else if(succ == nullptr) {
-			closest = pre->getId();
-		}
-		else{
-			Stats preStats = pre->getStats();
-			Stats succStats = succ->getStats();
-			closest = playerStats.getClosest(&preStats, &succStats);
-		}
-		return output_t<int>(closest);
+	TreeNode<Team, int, TeamAggregate>* teamNode = this->teams->tryFind(teamId);
+	if(teamNode == nullptr) {
+		return output_t<int>(StatusType::FAILURE);
 	}
-	catch(const std::exception& e){
+	TreeNode<Player, int>* playerNode = teamNode->data->getPlayersById()->tryFind(playerId);
+	if(playerNode == nullptr) {
 		return output_t<int>(StatusType::FAILURE);
 	}
-	return 1006;
+	Player* player = playerNode->data;
+	TreeNode<Player, Stats>* preNode = AVLTree<Player, Stats>::prev(player->getStatsNode());
+	TreeNode<Player, Stats>* succNode = AVLTree<Player, Stats>::next(player->getStatsNode());
+	Player* pre = (preNode != nullptr) ? preNode->data : nullptr;
+	Player* succ = (succNode != nullptr) ? succNode->data : nullptr;
+	Stats playerStats = player->getStats();
+	int closest;
+	if(pre == nullptr && succ == nullptr){
+		return output_t<int>(StatusType::FAILURE);
+	}
+	else if(pre == nullptr) {
+		closest = succ->getId();
+	}
+	else if(succ == nullptr) {
+		closest = pre->getId();
+	}
+	else{
+		Stats preStats = pre->getStats();
+		Stats succStats = succ->getStats();
+		closest = playerStats.getClosest(&preStats, &succStats);
+	}
+	return output_t<int>(closest);
 }
 
-struct TeamSim {
-	int teamId;
-	int points;
-	struct TeamSim* next;
-};
+output_t<int> world_cup_t::knockout_winner(int minTeamId, int maxTeamId){
+	if (minTeamId < 0 || maxTeamId < 0 || maxTeamId < minTeamId){
+		return output_t<int>(StatusType::INVALID_INPUT);
+	}
+	int winner;
+	if(this->knockoutCache->find(minTeamId, maxTeamId, winner)) {
+		return (winner != 0) ? output_t<int>(winner) : output_t<int>(StatusType::FAILURE);
+	}
+	int before = this->kosherTeams->rank(minTeamId - 1); //kosher teams below the range
+	int count = this->kosherTeams->rank(maxTeamId) - before;
+	if(count == 0){
+		this->knockoutCache->store(minTeamId, maxTeamId, 0);
+		return output_t<int>(StatusType::FAILURE);
+	}
+	this->knockout->clear();
+	if(!this->knockout->reserve(count)){
+		return output_t<int>(StatusType::ALLOCATION_ERROR);
+	}
+	Team* curr = this->kosherTeams->select(before + 1)->data;
+	for(int i = 0; i < count; i++){
+		this->knockout->add(curr->getID(), curr->getMatchScore());
+		curr = curr->getNextKosher();
+	}
+	winner = this->knockout->play();
+	this->knockoutCache->store(minTeamId, maxTeamId, winner);
+	return output_t<int>(winner);
+}
 
-static TreeNode<Team, int>* findMinInRange(TreeNode<Team, int>* root, int low, int high){
-	TreeNode<Team, int>* curr = root;
-	TreeNode<Team, int>* res = nullptr;
-	while(curr != nullptr){ //Get to range
-		if(curr->key < low){
-			curr = curr->right;
-		}
-		else if(curr->key > high) {
-			curr = curr->left;
-		}
-		else{
-			res = curr;
-            curr = curr->left;
-		}
+output_t<int> world_cup_t::get_scoring_rank(int playerId, int teamId)
+{
+	if(playerId <= 0 || teamId == 0) {
+		return output_t<int>(StatusType::INVALID_INPUT);
+	}
+	AVLTree<Player, Stats>* tree = this->getPlayersByStats(teamId);
+	TreeNode<Player, int>* playerNode = this->playersById->tryFind(playerId);
+	if(tree == nullptr || playerNode == nullptr) {
+		return output_t<int>(StatusType::FAILURE);
+	}
+	Stats stats = playerNode->data->getStats();
+	if(tree->tryFind(stats) == nullptr) { //the player is not in this team
+		return output_t<int>(StatusType::FAILURE);
 	}
-	return res;
+	return output_t<int>(tree->getSize() - tree->rank(stats) + 1);
 }
 
-static void playGames(TeamSim* teams){
-	TeamSim* curr = teams;
-	while(curr->next != nullptr && curr->next->next != nullptr){
-		if (curr->next->points > curr->next->next->points){
-			curr->next->points += 3;
-			curr->next->points += curr->next->next->points;
-			TeamSim* toDelete = curr->next->next;
-			curr->next->next = curr->next->next->next;
-			delete toDelete;
-		}
-		else if (curr->next->points < curr->next->next->points){
-			curr->next->next->points += 3;
-			curr->next->next->points += curr->next->points;
-			TeamSim* toDelete = curr->next;
-			curr->next = curr->next->next;
-			delete toDelete;
-		}
-		else if (curr->next->teamId > curr->next->next->teamId){
-			curr->next->points += 3;
-			curr->next->points += curr->next->next->points;
-			TeamSim* toDelete = curr->next->next;
-			curr->next->next = curr->next->next->next;
-			delete toDelete;
-		}
-		else{
-			curr->next->next->points += 3;
-			curr->next->next->points += curr->next->points;
-			TeamSim* toDelete = curr->next;
-			curr->next = curr->next->next;
-			delete toDelete;
-		}
-		curr = curr->next;
+output_t<int> world_cup_t::get_kth_top_scorer(int teamId, int k)
+{
+	if(teamId == 0 || k <= 0) {
+		return output_t<int>(StatusType::INVALID_INPUT);
 	}
+	AVLTree<Player, Stats>* tree = this->getPlayersByStats(teamId);
+	if(tree == nullptr || k > tree->getSize()) {
+		return output_t<int>(StatusType::FAILURE);
+	}
+	return output_t<int>(tree->select(tree->getSize() - k + 1)->data->getId());
 }
 
-output_t<int> world_cup_t::knockout_winner(int minTeamId, int maxTeamId){
+output_t<int> world_cup_t::get_kosher_count(int minTeamId, int maxTeamId)
+{
+	if (minTeamId < 0 || maxTeamId < 0 || maxTeamId < minTeamId){
+		return output_t<int>(StatusType::INVALID_INPUT);
+	}
+	return output_t<int>(this->kosherTeams->rank(maxTeamId) - this->kosherTeams->rank(minTeamId - 1));
+}
+
+output_t<int> world_cup_t::get_goals_in_range(int minTeamId, int maxTeamId)
+{
 	if (minTeamId < 0 || maxTeamId < 0 || maxTeamId < minTeamId){
 		return output_t<int>(StatusType::INVALID_INPUT);
 	}
-	TreeNode<Team, int>* minTeamNode = findMinInRange(this->kosherTeams->root, minTeamId, maxTeamId);
-	if(minTeamNode == nullptr){
+	return output_t<int>(this->teams->aggregate(minTeamId, maxTeamId).goals);
+}
+
+output_t<int> world_cup_t::get_cards_in_range(int minTeamId, int maxTeamId)
+{
+	if (minTeamId < 0 || maxTeamId < 0 || maxTeamId < minTeamId){
+		return output_t<int>(StatusType::INVALID_INPUT);
+	}
+	return output_t<int>(this->teams->aggregate(minTeamId, maxTeamId).cards);
+}
+
+output_t<int> world_cup_t::get_points_in_range(int minTeamId, int maxTeamId)
+{
+	if (minTeamId < 0 || maxTeamId < 0 || maxTeamId < minTeamId){
+		return output_t<int>(StatusType::INVALID_INPUT);
+	}
+	return output_t<int>(this->teams->aggregate(minTeamId, maxTeamId).points);
+}
+
+output_t<int> world_cup_t::get_best_team_in_range(int minTeamId, int maxTeamId)
+{
+	if (minTeamId < 0 || maxTeamId < 0 || maxTeamId < minTeamId){
+		return output_t<int>(StatusType::INVALID_INPUT);
+	}
+	const Team* best = this->teams->aggregate(minTeamId, maxTeamId).best;
+	if(best == nullptr) {
 		return output_t<int>(StatusType::FAILURE);
 	}
-	TeamSim* teams = new TeamSim;
-	teams->teamId = -1;
-	teams->points = -1;
-	shared_ptr<Team> curr = minTeamNode->data;
-	TeamSim* currTeamSim = teams;
-	while(curr != nullptr && curr->getID() <= maxTeamId){
-		TeamSim* newTeam = new TeamSim;
-		newTeam->teamId = curr->getID();
-		newTeam->points = curr->getPoints() + curr->getTotalGoals() - curr->getTotalCards();
-		newTeam->next = nullptr;
-		currTeamSim->next = newTeam;
-		currTeamSim = currTeamSim->next;
-		curr = curr->getNextKosher();
+	return output_t<int>(best->getID());
+}
+
+output_t<int> world_cup_t::get_top_scorer_in_range(int minTeamId, int maxTeamId)
+{
+	if (minTeamId < 0 || maxTeamId < 0 || maxTeamId < minTeamId){
+		return output_t<int>(StatusType::INVALID_INPUT);
 	}
-	while(teams->next->next != nullptr){
-		playGames(teams);
+	const Player* topScorer = this->teams->aggregate(minTeamId, maxTeamId).topScorer;
+	if(topScorer == nullptr) {
+		return output_t<int>(StatusType::FAILURE);
 	}
-	int winner = teams->next->teamId;
-	delete teams->next;
-	delete teams;
-	return output_t<int>(winner);
-}
\ No newline at end of file
+	return output_t<int>(topScorer->getId());
+}
+
+output_t<int> world_cup_t::get_top_teams(int k, int *const output)
+{
+	if(k <= 0 || output == nullptr) {
+		return output_t<int>(StatusType::INVALID_INPUT);
+	}
+	int count = 0;
+	TreeNode<Team, MatchScore>* node = this->teamsByScore->select(this->teamsByScore->getSize());
+	for(; node != nullptr && count < k; node = AVLTree<Team, MatchScore>::prev(node)) {
+		output[count++] = node->data->getID();
+	}
+	return output_t<int>(count);
+}
+
+output_t<int> world_cup_t::get_teams_with_score_count(int minScore)
+{
+	//team ids are positive, so (minScore, 0) falls just below every team with a score of minScore
+	return output_t<int>(this->teamsByScore->getSize() - this->teamsByScore->rank(MatchScore(minScore, 0)));
+}
+
+StatusType world_cup_t::get_teams_with_score(int minScore, int *const output)
+{
+	TreeNode<Team, MatchScore>* node = this->teamsByScore->select(this->teamsByScore->getSize());
+	if(node != nullptr && node->key.score >= minScore && output == nullptr) {
+		return StatusType::INVALID_INPUT;
+	}
+	for(int i = 0; node != nullptr && node->key.score >= minScore; node = AVLTree<Team, MatchScore>::prev(node)) {
+		output[i++] = node->data->getID();
+	}
+	return StatusType::SUCCESS;
+}
+
+output_t<int> world_cup_t::get_top_k_scorers(int teamId, int k, int *const output)
+{
+	if(teamId == 0 || k <= 0 || output == nullptr) {
+		return output_t<int>(StatusType::INVALID_INPUT);
+	}
+	AVLTree<Player, Stats>* tree = this->getPlayersByStats(teamId);
+	if(tree == nullptr) {
+		return output_t<int>(StatusType::FAILURE);
+	}
+	//walk back from the best scorer, so only the k players returned are visited
+	int count = 0;
+	TreeNode<Player, Stats>* node = tree->select(tree->getSize());
+	for(; node != nullptr && count < k; node = AVLTree<Player, Stats>::prev(node)) {
+		output[count++] = node->data->getId();
+	}
+	return output_t<int>(count);
+}
+
+output_t<int> world_cup_t::get_all_players_page(int teamId, PlayersCursor* cursor, int pageSize, int *const output)
+{
+	if(teamId == 0 || cursor == nullptr || pageSize <= 0 || output == nullptr) {
+		return output_t<int>(StatusType::INVALID_INPUT);
+	}
+	AVLTree<Player, Stats>* tree = this->getPlayersByStats(teamId);
+	if(tree == nullptr) {
+		return output_t<int>(StatusType::FAILURE);
+	}
+	TreeNode<Player, Stats>* node;
+	if(!cursor->hasKey) {
+		node = tree->select(1);
+	}
+	else if(cursor->inclusive) {
+		node = tree->lowerBound(cursor->key);
+	}
+	else {
+		node = tree->upperBound(cursor->key);
+	}
+	int count = 0;
+	for(; node != nullptr && count < pageSize; node = AVLTree<Player, Stats>::next(node)) {
+		output[count++] = node->data->getId();
+		cursor->key = node->key;
+		cursor->hasKey = true;
+		cursor->inclusive = false;
+	}
+	cursor->done = (node == nullptr);
+	return output_t<int>(count);
+}
+
+StatusType world_cup_t::execute_batch(const Command* cmds, size_t n, Result* out)
+{
+	if(n > 0 && (cmds == nullptr || out == nullptr)) {
+		return StatusType::INVALID_INPUT;
+	}
+	for(size_t i = 0; i < n; i++) {
+		this->execute(cmds[i], out[i]);
+	}
+	return StatusType::SUCCESS;
+}
+
+//run command and write what it returned to result
+void world_cup_t::execute(const Command& command, Result& result)
+{
+	const int* d = command.args;
+	result.type = command.type;
+	result.answer = 0;
+	result.players = nullptr;
+	result.playerCount = 0;
+	switch (command.type) {
+		case CommandType::ADD_TEAM:
+			result.status = this->add_team(d[0], d[1]);
+			break;
+		case CommandType::REMOVE_TEAM:
+			result.status = this->remove_team(d[0]);
+			break;
+		case CommandType::ADD_PLAYER:
+			result.status = this->add_player(d[0], d[1], d[2], d[3], d[4], command.goalKeeper);
+			break;
+		case CommandType::REMOVE_PLAYER:
+			result.status = this->remove_player(d[0]);
+			break;
+		case CommandType::UPDATE_PLAYER_STATS:
+			result.status = this->update_player_stats(d[0], d[1], d[2], d[3]);
+			break;
+		case CommandType::PLAY_MATCH:
+			result.status = this->play_match(d[0], d[1]);
+			break;
+		case CommandType::GET_NUM_PLAYED_GAMES:
+			setResult(result, this->get_num_played_games(d[0]));
+			break;
+		case CommandType::GET_TEAM_POINTS:
+			setResult(result, this->get_team_points(d[0]));
+			break;
+		case CommandType::UNITE_TEAMS:
+			result.status = this->unite_teams(d[0], d[1], d[2]);
+			break;
+		case CommandType::GET_TOP_SCORER:
+			setResult(result, this->get_top_scorer(d[0]));
+			break;
+		case CommandType::GET_ALL_PLAYERS_COUNT:
+			setResult(result, this->get_all_players_count(d[0]));
+			break;
+		case CommandType::GET_ALL_PLAYERS:
+			this->queryAllPlayers(d[0], result);
+			break;
+		case CommandType::GET_CLOSEST_PLAYER:
+			setResult(result, this->get_closest_player(d[0], d[1]));
+			break;
+		case CommandType::KNOCKOUT_WINNER:
+			setResult(result, this->knockout_winner(d[0], d[1]));
+			break;
+	}
+}
+
+void world_cup_t::setResult(Result& result, output_t<int> output)
+{
+	result.status = output.status();
+	result.answer = output.ans();
+}
+
+//get_all_players into a new array sized from the tree it walks, so the team is looked up once
+void world_cup_t::queryAllPlayers(int teamId, Result& result)
+{
+	if(teamId == 0) {
+		result.status = StatusType::INVALID_INPUT;
+		return;
+	}
+	AVLTree<Player, Stats>* tree = this->getPlayersByStats(teamId);
+	if(tree == nullptr) {
+		result.status = StatusType::FAILURE;
+		return;
+	}
+	int count = tree->getSize();
+	int* output = nullptr;
+	if(count > 0) {
+		output = new (std::nothrow) int[count];
+		if(output == nullptr) {
+			result.status = StatusType::ALLOCATION_ERROR;
+			return;
+		}
+	}
+	int i = 0;
+	for(TreeNode<Player, Stats>* node = tree->select(1); node != nullptr; node = AVLTree<Player, Stats>::next(node)) {
+		output[i++] = node->data->getId();
+	}
+	result.status = StatusType::SUCCESS;
+	result.players = output;
+	result.playerCount = count;
+}
@@ -20,14 +20,30 @@
 #include "Team.h"
 #include "Player.h"
 #include "Team.h"
+#include "Knockout.h"
+#include "KnockoutCache.h"
+#include "PlayersCursor.h"
+#include "Command.h"
+#include "Result.h"
+#include <cstddef>
 
 class world_cup_t {
 private:
-	AVLTree<Team, int>* teams;
+	AVLTree<Team, int, TeamAggregate>* teams; //keeps the goals, cards, points, best team and top scorer of every id range
 	AVLTree<Team, int>* kosherTeams;
-	AVLTree<Player, int>* playersById;
+	AVLTree<Team, MatchScore>* teamsByScore; //the league table, linking the teams' score nodes
+	AVLTree<Player, int>* playersById; //owns the players, each linked in by its own id node
 	AVLTree<Player, Stats>* playersByStats;
-	shared_ptr<Player> topScorer;
+	Player* topScorer;
+	ObjectPool<TeamSet>* teamSets; //owns the union-find sets of every team and of the teams united into it
+	Knockout* knockout; //scratch space reused by every knockout_winner
+	KnockoutCache* knockoutCache; //results of recent knockout_winner queries
+
+	AVLTree<Player, Stats>* getPlayersByStats(int teamId) const;
+	void refreshTeam(Team* team);
+	void execute(const Command& command, Result& result);
+	static void setResult(Result& result, output_t<int> output);
+	void queryAllPlayers(int teamId, Result& result);
 	
 public:
 	// <DO-NOT-MODIFY> {
@@ -66,6 +82,54 @@ public:
 	output_t<int> knockout_winner(int minTeamId, int maxTeamId);
 	
 	// } </DO-NOT-MODIFY>
+
+	// the position of the player among the top scorers of the league (teamId < 0) or of
+	// team teamId, where the top scorer is 1. O(log n)
+	output_t<int> get_scoring_rank(int playerId, int teamId);
+
+	// the id of the k-th best scorer of the league (teamId < 0) or of team teamId,
+	// counting from 1. O(log n)
+	output_t<int> get_kth_top_scorer(int teamId, int k);
+
+	// the number of kosher teams - teams that can play a knockout - with ids in
+	// [minTeamId, maxTeamId]. O(log n)
+	output_t<int> get_kosher_count(int minTeamId, int maxTeamId);
+
+	// the total goals, cards and points of the teams with ids in [minTeamId, maxTeamId]. O(log n)
+	output_t<int> get_goals_in_range(int minTeamId, int maxTeamId);
+	output_t<int> get_cards_in_range(int minTeamId, int maxTeamId);
+	output_t<int> get_points_in_range(int minTeamId, int maxTeamId);
+
+	// the id of the team with the highest match score among the teams with ids in
+	// [minTeamId, maxTeamId], the highest id on a tie. O(log n)
+	output_t<int> get_best_team_in_range(int minTeamId, int maxTeamId);
+
+	// the id of the best scorer among the players of the teams with ids in
+	// [minTeamId, maxTeamId]. O(log n)
+	output_t<int> get_top_scorer_in_range(int minTeamId, int maxTeamId);
+
+	// the ids of the k teams with the highest match scores, best first, where the
+	// higher id wins a tie. writes min(k, number of teams) ids and returns how many. O(log n + k)
+	output_t<int> get_top_teams(int k, int *const output);
+
+	// the number of teams with a match score of at least minScore. O(log n)
+	output_t<int> get_teams_with_score_count(int minScore);
+
+	// the ids of the teams with a match score of at least minScore, best first. O(log n + k)
+	StatusType get_teams_with_score(int minScore, int *const output);
+
+	// the ids of the k best scorers of the league (teamId < 0) or of team teamId, best
+	// first. writes min(k, number of players) ids and returns how many. O(log n + k)
+	output_t<int> get_top_k_scorers(int teamId, int k, int *const output);
+
+	// the next page of get_all_players: up to pageSize ids from where cursor stands, which
+	// is then moved past them. returns how many ids were written. O(log n + pageSize)
+	output_t<int> get_all_players_page(int teamId, PlayersCursor* cursor, int pageSize, int *const output);
+
+	// run the n commands of cmds in order, as if each method were called on its own, and
+	// write what command i returned to out[i]. a successful get_all_players hands its ids
+	// over in out[i].players, which the caller must delete[]. O(the cost of the commands)
+	StatusType execute_batch(const Command* cmds, size_t n, Result* out);
 };
 
 #endif // WORLDCUP23A1_H_